@@ -31,10 +31,7 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     _input,
     Direction::In,
     [&] {
-      string data;
-      data.resize( _outbound.writer().available_capacity() );
-      _input.read( data );
-      _outbound.writer().push( move( data ) );
+      _outbound.writer().fill_from( _input );
       if ( _input.eof() ) {
         _outbound.writer().close();
       }
@@ -56,9 +53,7 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     socket,
     Direction::Out,
     [&] {
-      if ( _outbound.reader().bytes_buffered() ) {
-        _outbound.reader().pop( socket.write( _outbound.reader().peek() ) );
-      }
+      _outbound.reader().drain_to( socket );
       if ( _outbound.reader().is_finished() ) {
         socket.shutdown( SHUT_WR );
         _outbound_shutdown = true;
@@ -81,10 +76,7 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     socket,
     Direction::In,
     [&] {
-      string data;
-      data.resize( _inbound.writer().available_capacity() );
-      socket.read( data );
-      _inbound.writer().push( move( data ) );
+      _inbound.writer().fill_from( socket );
       if ( socket.eof() ) {
         _inbound.writer().close();
       }
@@ -106,9 +98,7 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     _output,
     Direction::Out,
     [&] {
-      if ( _inbound.reader().bytes_buffered() ) {
-        _inbound.reader().pop( _output.write( _inbound.reader().peek() ) );
-      }
+      _inbound.reader().drain_to( _output );
       if ( _inbound.reader().is_finished() ) {
         _output.close();
         _inbound_shutdown = true;
@@ -31,15 +31,31 @@ void show_usage( const char* argv0, const char* msg )
        << "   -s <port>       Set source port (client mode only)              (random)\n\n"
 
        << "   -w <winsz>      Use a window of <winsz> bytes                   " << TCPConfig::MAX_PAYLOAD_SIZE
-       << "\n\n"
-
-       << "   -t <tmout>      Set rt_timeout to tmout                         " << TCPConfig::TIMEOUT_DFLT << "\n\n"
+       << "\n"
+       << "   -W <maxwin>     Autotune the window up to <maxwin> bytes        (no autotuning)\n"
+       << "   -F <maxfrag>    Store at most <maxfrag> out-of-order fragments  (no limit)\n"
+       << "   -S <blocks>     Report up to <blocks> SACK blocks (at most 4)   (no SACK)\n\n"
+
+       << "   -m <mss>        Send up to <mss> payload bytes per segment      " << TCPConfig::MAX_PAYLOAD_SIZE
+       << "\n"
+       << "   -P <maxmss>     Probe the path MTU for segments up to <maxmss>  (no probing)\n"
+       << "   -C <algo>       Congestion control: newreno or cubic            (none)\n"
+       << "   -D              Fast retransmit on duplicate ACKs               (on with -C, else off)\n"
+       << "   -H              Resend the holes the peer's SACK blocks show    (oldest segment only)\n"
+       << "   -p              Pace each window over the RTT (needs -R)        (no pacing)\n"
+       << "   -r <rate>       Pace at most <rate> bytes per second            (no limit)\n"
+       << "   -N <mode>       Hold small segments: nagle or cork              (send at once)\n\n"
+
+       << "   -t <tmout>      Set rt_timeout to tmout                         " << TCPConfig::TIMEOUT_DFLT << "\n"
+       << "   -R <minrto>     Adapt the RTO to the RTT, down to <minrto> ms   (fixed RTO)\n\n"
 
        << "   -d <tundev>     Connect to tun <tundev>                         " << TUN_DFLT << "\n\n"
 
        << "   -Lu <loss>      Set uplink loss to <rate> (float in 0..1)       (no loss)\n"
        << "   -Ld <loss>      Set downlink loss to <rate> (float in 0..1)     (no loss)\n\n"
 
+       << "   -v              Print statistics when the connection ends       (quiet)\n\n"
+
        << "   -h              Show this message.\n\n";
 
   if ( msg != nullptr ) {
@@ -56,7 +72,7 @@ void check_argc( const span<char*>& args, size_t curr, const char* err )
   }
 }
 
-tuple<TCPConfig, FdAdapterConfig, bool, const char*> get_config( const span<char*>& args )
+tuple<TCPConfig, FdAdapterConfig, bool, const char*, bool> get_config( const span<char*>& args )
 {
   TCPConfig c_fsm {};
   c_fsm.isn = Wrap32 { random_device()() };
@@ -66,6 +82,7 @@ tuple<TCPConfig, FdAdapterConfig, bool, const char*> get_config( const span<char
 
   size_t curr = 1;
   bool listen = false;
+  bool print_stats = false;
   const size_t argc = args.size();
 
   string source_address = LOCAL_ADDRESS_DFLT;
@@ -91,6 +108,77 @@ tuple<TCPConfig, FdAdapterConfig, bool, const char*> get_config( const span<char
       c_fsm.recv_capacity = strtol( args[curr + 1], nullptr, 0 );
       curr += 2;
 
+    } else if ( strncmp( "-W", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -W requires one argument." );
+      c_fsm.max_recv_capacity = strtol( args[curr + 1], nullptr, 0 );
+      curr += 2;
+
+    } else if ( strncmp( "-F", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -F requires one argument." );
+      c_fsm.max_fragments = strtol( args[curr + 1], nullptr, 0 );
+      curr += 2;
+
+    } else if ( strncmp( "-S", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -S requires one argument." );
+      c_fsm.sack_blocks = strtol( args[curr + 1], nullptr, 0 );
+      curr += 2;
+
+    } else if ( strncmp( "-m", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -m requires one argument." );
+      c_fsm.mss = strtol( args[curr + 1], nullptr, 0 );
+      curr += 2;
+
+    } else if ( strncmp( "-P", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -P requires one argument." );
+      c_fsm.probe_mss = strtol( args[curr + 1], nullptr, 0 );
+      curr += 2;
+
+    } else if ( strncmp( "-C", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -C requires one argument." );
+      if ( strcmp( "newreno", args[curr + 1] ) == 0 ) {
+        c_fsm.congestion_control = CongestionControl::Algorithm::NewReno;
+      } else if ( strcmp( "cubic", args[curr + 1] ) == 0 ) {
+        c_fsm.congestion_control = CongestionControl::Algorithm::Cubic;
+      } else {
+        show_usage( args[0], "ERROR: -C takes newreno or cubic." );
+        exit( 1 );
+      }
+      curr += 2;
+
+    } else if ( strncmp( "-N", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -N requires one argument." );
+      if ( strcmp( "nagle", args[curr + 1] ) == 0 ) {
+        c_fsm.coalescing = TCPConfig::Coalescing::Nagle;
+      } else if ( strcmp( "cork", args[curr + 1] ) == 0 ) {
+        c_fsm.coalescing = TCPConfig::Coalescing::Cork;
+      } else {
+        show_usage( args[0], "ERROR: -N takes nagle or cork." );
+        exit( 1 );
+      }
+      curr += 2;
+
+    } else if ( strncmp( "-D", args[curr], 3 ) == 0 ) {
+      c_fsm.fast_retransmit = true;
+      curr += 1;
+
+    } else if ( strncmp( "-H", args[curr], 3 ) == 0 ) {
+      c_fsm.sack_retransmit = true;
+      curr += 1;
+
+    } else if ( strncmp( "-p", args[curr], 3 ) == 0 ) {
+      c_fsm.pacing = true;
+      curr += 1;
+
+    } else if ( strncmp( "-r", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -r requires one argument." );
+      c_fsm.pacing_rate = strtol( args[curr + 1], nullptr, 0 );
+      curr += 2;
+
+    } else if ( strncmp( "-R", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -R requires one argument." );
+      c_fsm.min_rto = strtol( args[curr + 1], nullptr, 0 );
+      curr += 2;
+
     } else if ( strncmp( "-t", args[curr], 3 ) == 0 ) {
       check_argc( args, curr, "ERROR: -t requires one argument." );
       c_fsm.rt_timeout = strtol( args[curr + 1], nullptr, 0 );
@@ -117,6 +205,10 @@ tuple<TCPConfig, FdAdapterConfig, bool, const char*> get_config( const span<char
         = static_cast<LossRateDnT>( static_cast<float>( numeric_limits<LossRateDnT>::max() ) * lossrate );
       curr += 2;
 
+    } else if ( strncmp( "-v", args[curr], 3 ) == 0 ) {
+      print_stats = true;
+      curr += 1;
+
     } else if ( strncmp( "-h", args[curr], 3 ) == 0 ) {
       show_usage( args[0], nullptr );
       exit( 0 );
@@ -139,7 +231,7 @@ tuple<TCPConfig, FdAdapterConfig, bool, const char*> get_config( const span<char
     c_filt.source = { source_address, source_port };
   }
 
-  return make_tuple( c_fsm, c_filt, listen, tundev );
+  return make_tuple( c_fsm, c_filt, listen, tundev, print_stats );
 }
 } // namespace
 
@@ -157,7 +249,7 @@ int main( int argc, char** argv )
       return EXIT_FAILURE;
     }
 
-    auto [c_fsm, c_filt, listen, tun_dev_name] = get_config( args );
+    auto [c_fsm, c_filt, listen, tun_dev_name, print_stats] = get_config( args );
     LossyTCPOverIPv4MinnowSocket tcp_socket( LossyFdAdapter<TCPOverIPv4OverTunFdAdapter>(
       TCPOverIPv4OverTunFdAdapter( TunFD( tun_dev_name == nullptr ? TUN_DFLT : tun_dev_name ) ) ) );
 
@@ -169,6 +261,11 @@ int main( int argc, char** argv )
 
     bidirectional_stream_copy( tcp_socket, tcp_socket.peer_address().to_string() );
     tcp_socket.wait_until_closed();
+
+    if ( print_stats ) {
+      cerr << "Sender: " << tcp_socket.sender_stats().to_string() << "\n";
+      cerr << "Reassembler: " << tcp_socket.reassembler_stats().to_string() << "\n";
+    }
   } catch ( const exception& e ) {
     cerr << "Exception: " << e.what() << endl;
     return EXIT_FAILURE;
@@ -23,6 +23,12 @@ ttest(byte_stream_one_write)
 ttest(byte_stream_two_writes)
 ttest(byte_stream_many_writes)
 ttest(byte_stream_stress_test)
+ttest(byte_stream_chunked)
+ttest(byte_stream_peek_iovec)
+ttest(byte_stream_fd)
+ttest(byte_stream_concurrent)
+ttest(byte_stream_resize)
+ttest(buffer_pool)
 
 ttest(reassembler_single)
 ttest(reassembler_cap)
@@ -31,12 +37,18 @@ ttest(reassembler_dup)
 ttest(reassembler_holes)
 ttest(reassembler_overlapping)
 ttest(reassembler_win)
+ttest(reassembler_ring)
+ttest(reassembler_limits)
+ttest(reassembler_batch)
+ttest(reassembler_stats)
 
 ttest(wrapping_integers_cmp)
 ttest(wrapping_integers_wrap)
 ttest(wrapping_integers_unwrap)
 ttest(wrapping_integers_roundtrip)
 ttest(wrapping_integers_extra)
+ttest(wrapping_integers_batch)
+ttest(wrapping_integers_serial)
 
 ttest(recv_connect)
 ttest(recv_transmit)
@@ -45,6 +57,7 @@ ttest(recv_reorder)
 ttest(recv_reorder_more)
 ttest(recv_close)
 ttest(recv_special)
+ttest(recv_sack)
 
 ttest(send_connect)
 ttest(send_transmit)
@@ -53,6 +66,12 @@ ttest(send_window)
 ttest(send_ack)
 ttest(send_close)
 ttest(send_extra)
+ttest(send_mss)
+ttest(send_congestion)
+ttest(send_rtt)
+ttest(send_sack)
+ttest(send_pacing)
+ttest(send_coalescing)
 
 ttest(net_interface)
 
@@ -81,7 +100,7 @@ add_test(NAME ${compile_name_opt}
   COMMAND "${CMAKE_COMMAND}" --build "${CMAKE_BINARY_DIR}" -t speed_testing)
 
 macro (stest name)
-  add_test(NAME ${name} COMMAND ${name})
+  add_test(NAME ${name} COMMAND ${name} ${ARGN})
   set_property(TEST ${name} PROPERTY FIXTURES_REQUIRED compile_opt)
 endmacro (stest)
 
@@ -90,3 +109,13 @@ set_tests_properties(${compile_name_opt} PROPERTIES FIXTURES_SETUP compile_opt)
 
 stest(byte_stream_speed_test)
 stest(reassembler_speed_test)
+stest(byte_stream_matrix_speed_test --baseline "${PROJECT_SOURCE_DIR}/tests/byte_stream_matrix_baseline.csv")
+# compared with absolute throughputs from another run, so keep other tests from competing for the CPU
+set_property(TEST byte_stream_matrix_speed_test PROPERTY RUN_SERIAL TRUE)
+stest(wrapping_integers_speed_test)
+stest(tcp_mss_speed_test)
+stest(tcp_congestion_speed_test)
+stest(tcp_rto_speed_test)
+stest(tcp_sack_speed_test)
+stest(tcp_pacing_speed_test)
+stest(tcp_coalescing_speed_test)
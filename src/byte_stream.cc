@@ -1,8 +1,59 @@
 #include "byte_stream.hh"
+#include "buffer_pool.hh"
+#include "file_descriptor.hh"
+
+#include <algorithm>
+#include <span>
+#include <utility>
 
 using namespace std;
 
-ByteStream::ByteStream( uint64_t capacity ) : capacity_( capacity ) {}
+ByteStream::ByteStream( uint64_t capacity, Storage storage ) : capacity_( capacity ), storage_( storage ) {}
+
+ByteStream::~ByteStream()
+{
+  BufferPool& pool = BufferPool::global();
+  pool.give( move( buffer_ ) );
+  for ( auto& chunk : chunks_ ) {
+    pool.give( move( chunk ) );
+  }
+}
+
+void ByteStream::set_capacity( uint64_t capacity )
+{
+  capacity_ = max( capacity, pushed_len_ - popped_len_ );
+  if ( storage_ == Storage::Ring && buffer_.size() > capacity_ ) {
+    resize_ring( capacity_ );
+  }
+}
+
+void ByteStream::reserve_ring( uint64_t len )
+{
+  const uint64_t needed = pushed_len_ - popped_len_ + len;
+  if ( needed <= buffer_.size() ) {
+    return;
+  }
+  // grow geometrically so that a run of pushes costs amortized O(1) per byte
+  resize_ring( min( capacity_, max( { needed, 2 * buffer_.size(), MIN_RING_SIZE } ) ) );
+}
+
+void ByteStream::resize_ring( uint64_t size )
+{
+  const uint64_t buffered = pushed_len_ - popped_len_;
+  BufferPool& pool = BufferPool::global();
+  string resized = pool.take( size );
+  resized.resize( size );
+  const uint64_t first_len = min( buffered, buffer_.size() - head_ );
+  copy_n( buffer_.begin() + static_cast<ptrdiff_t>( head_ ), first_len, resized.begin() );
+  copy_n( buffer_.begin(), buffered - first_len, resized.begin() + static_cast<ptrdiff_t>( first_len ) );
+  pool.give( exchange( buffer_, move( resized ) ) );
+  head_ = 0;
+}
+
+uint64_t ByteStream::ring_tail() const
+{
+  return ( head_ + pushed_len_ - popped_len_ ) % buffer_.size();
+}
 
 bool Writer::is_closed() const
 {
@@ -14,11 +65,67 @@ void Writer::push( string data )
   if ( error_ || closed_ || data.empty() ) {
     return;
   }
-  const size_t len = min( available_capacity(), data.size() );
-  queue_.append( data.substr( 0, len ) );
+  const uint64_t len = min( available_capacity(), static_cast<uint64_t>( data.size() ) );
+  if ( len == 0 ) {
+    return;
+  }
+
+  if ( storage_ == Storage::Chunked ) {
+    data.resize( len ); // only the tail of this chunk can exceed the capacity
+    chunks_.push_back( move( data ) );
+    pushed_len_ += len;
+    return;
+  }
+
+  // copy into the free region after the tail, wrapping around to the front of buffer_ if needed
+  reserve_ring( len );
+  const uint64_t tail = ring_tail();
+  const uint64_t first_len = min( len, buffer_.size() - tail );
+  copy_n( data.begin(), first_len, buffer_.begin() + static_cast<ptrdiff_t>( tail ) );
+  copy_n( data.begin() + static_cast<ptrdiff_t>( first_len ), len - first_len, buffer_.begin() );
   pushed_len_ += len;
 }
 
+uint64_t Writer::fill_from( FileDescriptor& fd )
+{
+  if ( error_ || closed_ || available_capacity() == 0 ) {
+    return 0;
+  }
+
+  if ( storage_ == Storage::Chunked ) {
+    // read no more than a read buffer at a time, whatever the capacity, and keep a short read in a copy sized
+    // to it (recycling the buffer), so that the chunks cost about what they hold
+    const uint64_t len = min( available_capacity(), static_cast<uint64_t>( FileDescriptor::kReadBufferSize ) );
+    string chunk = BufferPool::global().take( len );
+    chunk.resize( len );
+    fd.read( chunk );
+    const uint64_t bytes_read = chunk.size();
+    if ( bytes_read < chunk.capacity() / 2 ) {
+      string copy { chunk };
+      BufferPool::global().give( exchange( chunk, move( copy ) ) );
+    }
+    push( move( chunk ) );
+    return bytes_read;
+  }
+
+  // offer the reader at least as much room as the ring already has, doubling it when that is used up
+  const uint64_t buffered = pushed_len_ - popped_len_;
+  const uint64_t len = min( available_capacity(), max( { buffer_.size() - buffered, buffered, MIN_RING_SIZE } ) );
+  reserve_ring( len );
+
+  // read into the free region after the tail, and the part that wraps around to the front of buffer_
+  const uint64_t tail = ring_tail();
+  const uint64_t first_len = min( len, buffer_.size() - tail );
+  vector<span<char>> regions { { buffer_.data() + tail, first_len } };
+  if ( first_len < len ) {
+    regions.emplace_back( buffer_.data(), len - first_len );
+  }
+
+  const uint64_t bytes_read = fd.read( regions );
+  pushed_len_ += bytes_read;
+  return bytes_read;
+}
+
 void Writer::close()
 {
   closed_ = true;
@@ -36,8 +143,7 @@ uint64_t Writer::bytes_pushed() const
 
 bool Reader::is_finished() const
 {
-  // Your code here.
-  return closed_ && queue_.empty();
+  return closed_ && bytes_buffered() == 0;
 }
 
 uint64_t Reader::bytes_popped() const
@@ -47,18 +153,77 @@ uint64_t Reader::bytes_popped() const
 
 string_view Reader::peek() const
 {
-  return { queue_ }; // 返回临时对象，隐式修改
+  if ( storage_ == Storage::Chunked ) {
+    return chunks_.empty() ? string_view {} : string_view { chunks_.front() }.substr( head_ );
+  }
+
+  // the buffered bytes may wrap around the end of buffer_; return the run up to the wrap point
+  const uint64_t len = min( bytes_buffered(), buffer_.size() - head_ );
+  return string_view { buffer_ }.substr( head_, len );
+}
+
+vector<string_view> Reader::peek_iovec( uint64_t max_views ) const
+{
+  vector<string_view> views; // the default limit matches IOV_MAX, so a single writev() accepts the result
+  if ( bytes_buffered() == 0 || max_views == 0 ) {
+    return views;
+  }
+
+  if ( storage_ == Storage::Chunked ) {
+    views.reserve( min( max_views, static_cast<uint64_t>( chunks_.size() ) ) );
+    views.push_back( peek() );
+    for ( auto it = chunks_.begin() + 1; it != chunks_.end() && views.size() < max_views; ++it ) {
+      views.emplace_back( *it );
+    }
+    return views;
+  }
+
+  views.push_back( peek() );
+  if ( views.back().size() < bytes_buffered() && max_views > 1 ) {
+    views.push_back( string_view { buffer_ }.substr( 0, bytes_buffered() - views.back().size() ) );
+  }
+  return views;
+}
+
+uint64_t Reader::drain_to( FileDescriptor& fd )
+{
+  if ( bytes_buffered() == 0 ) {
+    return 0;
+  }
+  const uint64_t bytes_written = fd.write( peek_iovec() );
+  pop( bytes_written );
+  return bytes_written;
 }
 
 void Reader::pop( uint64_t len )
 {
-  if ( error_ || queue_.empty() || len == 0 ) {
+  if ( error_ || len == 0 || bytes_buffered() == 0 ) {
     return;
   }
 
   len = min( len, bytes_buffered() );
-  queue_.erase( 0, len );
   popped_len_ += len;
+
+  if ( storage_ == Storage::Chunked ) {
+    while ( len > 0 ) {
+      const uint64_t from_front = min( len, chunks_.front().size() - head_ );
+      head_ += from_front;
+      len -= from_front;
+      if ( head_ == chunks_.front().size() ) {
+        BufferPool::global().give( move( chunks_.front() ) );
+        chunks_.pop_front();
+        head_ = 0;
+      }
+    }
+    return;
+  }
+
+  head_ = ( head_ + len ) % buffer_.size();
+
+  // give memory back once the ring is mostly empty, keeping the footprint proportional to bytes_buffered()
+  if ( buffer_.size() > MIN_RING_SIZE && bytes_buffered() * 4 <= buffer_.size() ) {
+    resize_ring( max( buffer_.size() / 2, MIN_RING_SIZE ) );
+  }
 }
 
 uint64_t Reader::bytes_buffered() const
@@ -1,16 +1,31 @@
 #pragma once
 
 #include <cstdint>
+#include <deque>
 #include <string>
 #include <string_view>
+#include <vector>
 
+class FileDescriptor;
 class Reader;
 class Writer;
 
 class ByteStream
 {
 public:
-  explicit ByteStream( uint64_t capacity );
+  // How the stream holds buffered bytes
+  enum class Storage
+  {
+    Ring,    // copy pushed bytes into a circular buffer that grows (and shrinks) with the buffered bytes
+    Chunked, // keep pushed strings as owned chunks, so a push never copies the payload
+  };
+
+  explicit ByteStream( uint64_t capacity, Storage storage = Storage::Ring );
+  ~ByteStream(); // hands the ring and any chunks back to the BufferPool
+  ByteStream( const ByteStream& other ) = default;
+  ByteStream& operator=( const ByteStream& other ) = default;
+  ByteStream( ByteStream&& other ) = default;
+  ByteStream& operator=( ByteStream&& other ) = default;
 
   // Helper functions (provided) to access the ByteStream's Reader and Writer interfaces
   Reader& reader();
@@ -21,10 +36,23 @@ public:
   void set_error() { error_ = true; };       // Signal that the stream suffered an error.
   bool has_error() const { return error_; }; // Has the stream had an error?
 
+  // Change the capacity at runtime. It never drops below the bytes already buffered.
+  void set_capacity( uint64_t capacity );
+  uint64_t capacity() const { return capacity_; }
+
 protected:
+  static constexpr uint64_t MIN_RING_SIZE = 4096; // smallest ring allocated, and the floor when shrinking
+
+  void reserve_ring( uint64_t len ); // grow the ring so that `len` more bytes fit, up to the capacity
+  void resize_ring( uint64_t size ); // move the buffered bytes to the front of a ring of `size` bytes
+  uint64_t ring_tail() const;        // offset in buffer_ just past the last buffered byte
+
   // Please add any additional state to the ByteStream here, and not to the Writer and Reader interfaces.
   uint64_t capacity_;
-  std::string queue_ {};
+  Storage storage_;
+  std::string buffer_ {};            // Ring: circular buffer, at most `capacity_` bytes
+  std::deque<std::string> chunks_ {}; // Chunked: pushed strings, front chunk is read first
+  uint64_t head_ { 0 };              // offset of the first buffered byte in buffer_ or chunks_.front()
   uint64_t pushed_len_ { 0 };
   uint64_t popped_len_ { 0 };
   bool closed_ { false };
@@ -37,6 +65,9 @@ public:
   void push( std::string data ); // Push data to stream, but only as much as available capacity allows.
   void close();                  // Signal that the stream has reached its ending. Nothing more will be written.
 
+  // Read from `fd` straight into the stream's storage, up to the available capacity; returns bytes read
+  uint64_t fill_from( FileDescriptor& fd );
+
   bool is_closed() const;              // Has the stream been closed?
   uint64_t available_capacity() const; // How many bytes can be pushed to the stream right now?
   uint64_t bytes_pushed() const;       // Total number of bytes cumulatively pushed to the stream
@@ -45,9 +76,15 @@ public:
 class Reader : public ByteStream
 {
 public:
-  std::string_view peek() const; // Peek at the next bytes in the buffer
+  std::string_view peek() const; // Peek at the next contiguous run of bytes in the buffer
   void pop( uint64_t len );      // Remove `len` bytes from the buffer
 
+  // Peek at every buffered region in order (at most `max_views` of them), e.g. to drain with one writev()
+  std::vector<std::string_view> peek_iovec( uint64_t max_views = 1024 ) const;
+
+  // Write buffered bytes to `fd` with one writev() and pop what was written; returns bytes written
+  uint64_t drain_to( FileDescriptor& fd );
+
   bool is_finished() const;        // Is the stream finished (closed and fully popped)?
   uint64_t bytes_buffered() const; // Number of bytes currently buffered (pushed and not popped)
   uint64_t bytes_popped() const;   // Total number of bytes cumulatively popped from stream
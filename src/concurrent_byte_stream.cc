@@ -0,0 +1,154 @@
+#include "concurrent_byte_stream.hh"
+#include "exception.hh"
+
+#include <algorithm>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+using namespace std;
+
+ConcurrentByteStream::ConcurrentByteStream( uint64_t capacity )
+  : capacity_( capacity )
+  , buffer_( make_unique<char[]>( capacity ) )
+  , wakeup_( CheckSystemCall( "eventfd", ::eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC ) ) )
+{}
+
+void ConcurrentByteStream::set_error()
+{
+  error_.store( true, memory_order_release );
+  notify();
+}
+
+bool ConcurrentByteStream::has_error() const
+{
+  return error_.load( memory_order_acquire );
+}
+
+// Either thread may notify (the reader does so on set_error()), so bypass FileDescriptor's unsynchronized counters
+void ConcurrentByteStream::notify()
+{
+  const uint64_t one = 1;
+  CheckSystemCall( "write", static_cast<int>( ::write( wakeup_.fd_num(), &one, sizeof( one ) ) ) );
+}
+
+void ConcurrentWriter::push( string data )
+{
+  if ( has_error() || is_closed() || data.empty() ) {
+    return;
+  }
+
+  const uint64_t pushed = pushed_len_.load( memory_order_relaxed );
+  const uint64_t len = min( available_capacity(), static_cast<uint64_t>( data.size() ) );
+  if ( len == 0 ) {
+    return;
+  }
+
+  const uint64_t tail = pushed % capacity_;
+  const uint64_t first_len = min( len, capacity_ - tail );
+  copy_n( data.data(), first_len, buffer_.get() + tail );
+  copy_n( data.data() + first_len, len - first_len, buffer_.get() );
+  pushed_len_.store( pushed + len, memory_order_release );
+
+  // Pairs with the fence in ConcurrentReader::pop(): either the reader sees these bytes before it decides
+  // to sleep, or we see that it had drained everything and wake it up.
+  atomic_thread_fence( memory_order_seq_cst );
+  if ( popped_len_.load( memory_order_relaxed ) == pushed ) {
+    notify();
+  }
+}
+
+void ConcurrentWriter::close()
+{
+  closed_.store( true, memory_order_release );
+  notify();
+}
+
+bool ConcurrentWriter::is_closed() const
+{
+  return closed_.load( memory_order_acquire );
+}
+
+uint64_t ConcurrentWriter::available_capacity() const
+{
+  return capacity_ - pushed_len_.load( memory_order_relaxed ) + popped_len_.load( memory_order_acquire );
+}
+
+uint64_t ConcurrentWriter::bytes_pushed() const
+{
+  return pushed_len_.load( memory_order_relaxed );
+}
+
+string_view ConcurrentReader::peek() const
+{
+  const uint64_t popped = popped_len_.load( memory_order_relaxed );
+  const uint64_t buffered = pushed_len_.load( memory_order_acquire ) - popped;
+  if ( buffered == 0 ) {
+    return {};
+  }
+  const uint64_t head = popped % capacity_;
+  return { buffer_.get() + head, min( buffered, capacity_ - head ) };
+}
+
+void ConcurrentReader::pop( uint64_t len )
+{
+  if ( has_error() ) {
+    return;
+  }
+  len = min( len, bytes_buffered() );
+  popped_len_.store( popped_len_.load( memory_order_relaxed ) + len, memory_order_release );
+  atomic_thread_fence( memory_order_seq_cst );
+}
+
+void ConcurrentReader::consume_wakeup()
+{
+  string counter( sizeof( uint64_t ), '\0' );
+  wakeup_.read( counter );
+}
+
+bool ConcurrentReader::is_finished() const
+{
+  // the writer pushes its last bytes before it closes, so check `closed_` first
+  return closed_.load( memory_order_acquire ) && bytes_buffered() == 0;
+}
+
+uint64_t ConcurrentReader::bytes_buffered() const
+{
+  return pushed_len_.load( memory_order_acquire ) - popped_len_.load( memory_order_relaxed );
+}
+
+uint64_t ConcurrentReader::bytes_popped() const
+{
+  return popped_len_.load( memory_order_relaxed );
+}
+
+ConcurrentReader& ConcurrentByteStream::reader()
+{
+  static_assert( sizeof( ConcurrentReader ) == sizeof( ConcurrentByteStream ),
+                 "Please add member variables to the ConcurrentByteStream base, not the ConcurrentReader." );
+
+  return static_cast<ConcurrentReader&>( *this ); // NOLINT(*-downcast)
+}
+
+const ConcurrentReader& ConcurrentByteStream::reader() const
+{
+  static_assert( sizeof( ConcurrentReader ) == sizeof( ConcurrentByteStream ),
+                 "Please add member variables to the ConcurrentByteStream base, not the ConcurrentReader." );
+
+  return static_cast<const ConcurrentReader&>( *this ); // NOLINT(*-downcast)
+}
+
+ConcurrentWriter& ConcurrentByteStream::writer()
+{
+  static_assert( sizeof( ConcurrentWriter ) == sizeof( ConcurrentByteStream ),
+                 "Please add member variables to the ConcurrentByteStream base, not the ConcurrentWriter." );
+
+  return static_cast<ConcurrentWriter&>( *this ); // NOLINT(*-downcast)
+}
+
+const ConcurrentWriter& ConcurrentByteStream::writer() const
+{
+  static_assert( sizeof( ConcurrentWriter ) == sizeof( ConcurrentByteStream ),
+                 "Please add member variables to the ConcurrentByteStream base, not the ConcurrentWriter." );
+
+  return static_cast<const ConcurrentWriter&>( *this ); // NOLINT(*-downcast)
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "file_descriptor.hh"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+class ConcurrentReader;
+class ConcurrentWriter;
+
+/*
+ * A ByteStream that one thread can write while another thread reads it.
+ *
+ * The writer and reader interfaces match ByteStream's. Exactly one thread may use the
+ * ConcurrentWriter and exactly one (other) thread may use the ConcurrentReader. Neither side
+ * takes a lock: the writer publishes bytes by advancing `pushed_len_`, the reader releases space by
+ * advancing `popped_len_`, and the two counters live on separate cache lines.
+ *
+ * A reader that wants to sleep instead of spinning can poll `wakeup_fd()` (an eventfd) for readability.
+ * The writer signals it when it pushes into a stream the reader had drained, or when it closes
+ * the stream. The reader should call `consume_wakeup()` before draining the stream.
+ */
+class ConcurrentByteStream
+{
+public:
+  explicit ConcurrentByteStream( uint64_t capacity );
+
+  ConcurrentReader& reader();
+  const ConcurrentReader& reader() const;
+  ConcurrentWriter& writer();
+  const ConcurrentWriter& writer() const;
+
+  void set_error();      // Signal that the stream suffered an error.
+  bool has_error() const; // Has the stream had an error?
+
+  // eventfd that becomes readable when the reader has something new to look at
+  FileDescriptor& wakeup_fd() { return wakeup_; }
+
+  // Shared between two threads, so cannot be copied or moved
+  ConcurrentByteStream( const ConcurrentByteStream& other ) = delete;
+  ConcurrentByteStream& operator=( const ConcurrentByteStream& other ) = delete;
+  ConcurrentByteStream( ConcurrentByteStream&& other ) = delete;
+  ConcurrentByteStream& operator=( ConcurrentByteStream&& other ) = delete;
+  ~ConcurrentByteStream() = default;
+
+protected:
+  static constexpr size_t CACHE_LINE_SIZE = 64;
+
+  void notify();
+
+  // Written only at construction
+  uint64_t capacity_;
+  std::unique_ptr<char[]> buffer_; // circular buffer of `capacity_` bytes
+  FileDescriptor wakeup_;
+
+  alignas( CACHE_LINE_SIZE ) std::atomic<uint64_t> pushed_len_ { 0 }; // written only by the writer
+  alignas( CACHE_LINE_SIZE ) std::atomic<uint64_t> popped_len_ { 0 }; // written only by the reader
+
+  alignas( CACHE_LINE_SIZE ) std::atomic<bool> closed_ { false };
+  std::atomic<bool> error_ { false };
+};
+
+class ConcurrentWriter : public ConcurrentByteStream
+{
+public:
+  void push( std::string data ); // Push data to stream, but only as much as available capacity allows.
+  void close();                  // Signal that the stream has reached its ending. Nothing more will be written.
+
+  bool is_closed() const;              // Has the stream been closed?
+  uint64_t available_capacity() const; // How many bytes can be pushed to the stream right now?
+  uint64_t bytes_pushed() const;       // Total number of bytes cumulatively pushed to the stream
+};
+
+class ConcurrentReader : public ConcurrentByteStream
+{
+public:
+  std::string_view peek() const; // Peek at the next contiguous run of bytes in the buffer
+  void pop( uint64_t len );      // Remove `len` bytes from the buffer
+
+  void consume_wakeup(); // Reset wakeup_fd() before draining the stream
+
+  bool is_finished() const;        // Is the stream finished (closed and fully popped)?
+  uint64_t bytes_buffered() const; // Number of bytes currently buffered (pushed and not popped)
+  uint64_t bytes_popped() const;   // Total number of bytes cumulatively popped from stream
+};
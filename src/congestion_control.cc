@@ -0,0 +1,139 @@
+#include "congestion_control.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+unique_ptr<CongestionControl> CongestionControl::make( Algorithm algorithm, size_t mss )
+{
+  switch ( algorithm ) {
+    case Algorithm::NewReno:
+      return make_unique<NewReno>( mss );
+    case Algorithm::Cubic:
+      return make_unique<Cubic>( mss );
+    case Algorithm::None:
+      break;
+  }
+  return nullptr;
+}
+
+CongestionControl::CongestionControl( size_t mss )
+  : mss_( mss )
+  , cwnd_( min( 10 * mss_, max<uint64_t>( 2 * mss_, 14600 ) ) ) // initial window of RFC 6928
+  , ssthresh_( numeric_limits<uint64_t>::max() )
+{}
+
+bool CongestionControl::on_ack( uint64_t ackno, uint64_t acked, uint64_t now_ms )
+{
+  duplicate_acks_ = 0;
+
+  if ( recover_.has_value() and not timed_out_ ) {
+    if ( ackno >= *recover_ ) { // everything outstanding at the loss is acknowledged: recovery is over
+      cwnd_ = ssthresh_;
+      recover_.reset();
+      return false;
+    }
+    // a partial ACK: the next segment was lost too, so resend it, and deflate the window by what left
+    cwnd_ = ( cwnd_ > acked ? cwnd_ - acked : 0 ) + mss_;
+    return true;
+  }
+
+  if ( cwnd_ < ssthresh_ ) {
+    cwnd_ += min( acked, mss_ ); // slow start
+  } else {
+    grow( acked, now_ms );
+  }
+
+  // after a timeout, the window restarts from one segment, but the holes behind the one the timer resent
+  // are still resent one per partial ACK instead of waiting out a timer each
+  if ( recover_.has_value() ) {
+    if ( ackno < *recover_ ) {
+      return true;
+    }
+    recover_.reset();
+    timed_out_ = false;
+  }
+  return false;
+}
+
+bool CongestionControl::on_duplicate_ack( uint64_t in_flight, uint64_t next_seqno, uint64_t now_ms )
+{
+  if ( recover_.has_value() ) {
+    if ( not timed_out_ ) {
+      cwnd_ += mss_; // each duplicate ACK means another segment has left the network
+    }
+    return false;
+  }
+
+  if ( ++duplicate_acks_ < DUPLICATE_ACK_THRESHOLD ) {
+    return false;
+  }
+
+  // fast retransmit, then fast recovery until everything sent so far is acknowledged
+  duplicate_acks_ = 0;
+  ssthresh_ = shrink( in_flight, now_ms );
+  cwnd_ = ssthresh_ + DUPLICATE_ACK_THRESHOLD * mss_;
+  recover_ = next_seqno;
+  return true;
+}
+
+void CongestionControl::on_timeout( uint64_t in_flight, uint64_t next_seqno, uint64_t now_ms )
+{
+  ssthresh_ = shrink( in_flight, now_ms );
+  cwnd_ = mss_;
+  duplicate_acks_ = 0;
+  recover_ = next_seqno;
+  timed_out_ = true;
+}
+
+void NewReno::grow( uint64_t acked, uint64_t now_ms [[maybe_unused]] )
+{
+  bytes_acked_ += acked;
+  if ( bytes_acked_ >= cwnd_ ) {
+    bytes_acked_ -= cwnd_;
+    cwnd_ += mss_;
+  }
+}
+
+uint64_t NewReno::shrink( uint64_t in_flight, uint64_t now_ms [[maybe_unused]] )
+{
+  bytes_acked_ = 0;
+  return max( in_flight / 2, 2 * mss_ );
+}
+
+void Cubic::grow( uint64_t acked, uint64_t now_ms )
+{
+  const double segments = static_cast<double>( cwnd_ ) / static_cast<double>( mss_ );
+  if ( not epoch_start_ms_.has_value() ) {
+    epoch_start_ms_ = now_ms;
+    if ( segments < w_max_ ) {
+      k_seconds_ = cbrt( ( w_max_ - segments ) / C );
+    } else {
+      k_seconds_ = 0;
+      w_max_ = segments;
+    }
+    w_est_ = segments;
+  }
+
+  const double t = static_cast<double>( now_ms - *epoch_start_ms_ ) / 1000.0;
+  const double w_cubic = C * pow( t - k_seconds_, 3 ) + w_max_;
+  w_est_ += 3 * ( 1 - BETA ) / ( 1 + BETA ) * static_cast<double>( acked ) / static_cast<double>( cwnd_ );
+
+  // grow toward the target over the next window, by at most half the window
+  const double target = min( max( w_cubic, w_est_ ), 1.5 * segments );
+  if ( target > segments ) {
+    cwnd_ += static_cast<uint64_t>( ( target - segments ) / segments * static_cast<double>( acked ) );
+  }
+}
+
+uint64_t Cubic::shrink( uint64_t in_flight [[maybe_unused]], uint64_t now_ms [[maybe_unused]] )
+{
+  const double segments = static_cast<double>( cwnd_ ) / static_cast<double>( mss_ );
+
+  // fast convergence: a flow that lost before regaining its old w_max releases bandwidth for newer flows
+  w_max_ = segments < w_max_ ? segments * ( 1 + BETA ) / 2 : segments;
+  epoch_start_ms_.reset();
+  return max( static_cast<uint64_t>( static_cast<double>( cwnd_ ) * BETA ), 2 * mss_ );
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+/*
+ * A congestion controller keeps the congestion window (cwnd): the most sequence numbers the TCPSender may
+ * have in flight, on top of the limit set by the receiver's window. The TCPSender reports each new
+ * acknowledgment, duplicate acknowledgment and timeout to it.
+ *
+ * This base class runs the parts common to loss-based algorithms (RFC 5681, with the NewReno recovery of
+ * RFC 6582): slow start, fast retransmit on the third duplicate ACK, and fast recovery, where the window is
+ * inflated by each further duplicate ACK and every partial ACK retransmits the next hole. Subclasses decide
+ * how the window grows in congestion avoidance and how far it shrinks after a loss.
+ */
+class CongestionControl
+{
+public:
+  enum class Algorithm
+  {
+    None, // no congestion window: send whatever the receiver's window allows
+    NewReno,
+    Cubic,
+  };
+
+  static constexpr unsigned DUPLICATE_ACK_THRESHOLD = 3; // duplicate ACKs that signal a lost segment
+
+  // Make the controller for `algorithm` (nullptr for None), for segments of `mss` bytes of payload
+  static std::unique_ptr<CongestionControl> make( Algorithm algorithm, size_t mss );
+
+  explicit CongestionControl( size_t mss );
+  virtual ~CongestionControl() = default;
+  CongestionControl( const CongestionControl& ) = default;
+  CongestionControl& operator=( const CongestionControl& ) = default;
+
+  virtual std::string_view name() const = 0;
+
+  uint64_t window() const { return cwnd_; }
+  uint64_t slow_start_threshold() const { return ssthresh_; }
+  bool in_recovery() const { return recover_.has_value() and not timed_out_; }
+
+  // The MSS changed (after path MTU discovery)
+  void set_mss( size_t mss ) { mss_ = mss; }
+
+  /*
+   * `acked` sequence numbers were newly acknowledged, up to absolute `ackno`. Returns true if the sender
+   * should retransmit its first outstanding segment now (a partial ACK during fast recovery, or after a
+   * timeout).
+   */
+  bool on_ack( uint64_t ackno, uint64_t acked, uint64_t now_ms );
+
+  /*
+   * A duplicate ACK arrived; `next_seqno` is the next absolute seqno the sender will use. Returns true if
+   * the sender should retransmit its first outstanding segment now (fast retransmit).
+   */
+  bool on_duplicate_ack( uint64_t in_flight, uint64_t next_seqno, uint64_t now_ms );
+
+  // The retransmission timer expired, with `in_flight` sequence numbers outstanding
+  void on_timeout( uint64_t in_flight, uint64_t next_seqno, uint64_t now_ms );
+
+protected:
+  // Grow cwnd_ in congestion avoidance, for `acked` newly acknowledged sequence numbers
+  virtual void grow( uint64_t acked, uint64_t now_ms ) = 0;
+
+  // A loss was detected with `in_flight` sequence numbers outstanding: return the new slow-start threshold
+  virtual uint64_t shrink( uint64_t in_flight, uint64_t now_ms ) = 0;
+
+  uint64_t mss_;
+  uint64_t cwnd_;
+  uint64_t ssthresh_;
+
+private:
+  unsigned duplicate_acks_ {};
+  std::optional<uint64_t> recover_ {}; // in recovery: the next seqno when the loss was detected
+  bool timed_out_ {};                  // ... by the retransmission timer rather than duplicate ACKs
+};
+
+// RFC 5681 congestion avoidance: one MSS per window's worth of acknowledged data, and half the flight on loss
+class NewReno : public CongestionControl
+{
+public:
+  using CongestionControl::CongestionControl;
+  std::string_view name() const override { return "NewReno"; }
+
+protected:
+  void grow( uint64_t acked, uint64_t now_ms ) override;
+  uint64_t shrink( uint64_t in_flight, uint64_t now_ms ) override;
+
+private:
+  uint64_t bytes_acked_ {}; // acknowledged since cwnd_ last grew
+};
+
+/*
+ * CUBIC (RFC 9438): after a loss, the window follows a cubic function of the time since the loss, which
+ * is flat around the window where the loss happened (w_max) and grows quickly away from it. It never
+ * grows slower than an estimate of what Reno would reach in the same time.
+ */
+class Cubic : public CongestionControl
+{
+public:
+  using CongestionControl::CongestionControl;
+  std::string_view name() const override { return "CUBIC"; }
+
+protected:
+  void grow( uint64_t acked, uint64_t now_ms ) override;
+  uint64_t shrink( uint64_t in_flight, uint64_t now_ms ) override;
+
+private:
+  static constexpr double BETA = 0.7; // multiplicative decrease
+  static constexpr double C = 0.4;    // scaling, in segments per second cubed
+
+  double w_max_ {};                           // window before the last reduction, in segments
+  double w_est_ {};                           // Reno-friendly window estimate, in segments
+  std::optional<uint64_t> epoch_start_ms_ {}; // when the current congestion avoidance period began
+  double k_seconds_ {};                       // time for the cubic function to climb back to w_max_
+};
@@ -1,96 +1,472 @@
 #include "reassembler.hh"
 #include <algorithm>
+#include <bit>
+#include <sstream>
+#include <utility>
 
 using namespace std;
 
+namespace {
+
+void count( Reassembler::Stats::Histogram& histogram, uint64_t value )
+{
+  ++histogram.at( min( static_cast<size_t>( bit_width( value ) ), histogram.size() - 1 ) );
+}
+
+} // namespace
+
 void Reassembler::insert( uint64_t first_index, string data, bool is_last_substring )
 {
-  // we need to deal with overlapping intervals in the inserted strings
-  uint64_t avail_capacity = output_.writer().available_capacity();
-  uint64_t unassembled_index_ = writer().bytes_pushed();
-  uint64_t first_unacceptable_index = unassembled_index_ + avail_capacity;
-  uint64_t end_index = first_index + data.size();
-  // [) interval
+  place( first_index, move( data ), is_last_substring );
+  flush();
+}
+
+void Reassembler::insert_batch( span<Substring> substrings )
+{
+  ranges::stable_sort( substrings, {}, &Substring::first_index );
 
+  for ( auto& [first_index, data, is_last_substring] : substrings ) {
+    place( first_index, move( data ), is_last_substring );
+  }
+  flush();
+}
+
+void Reassembler::place( uint64_t first_index, string&& data, bool is_last_substring )
+{
+  ++stats_.inserts;
   if ( is_last_substring ) {
-    eof_idx_ = end_index;
+    eof_idx_ = first_index + data.size();
   }
 
-  // 1. discard data beyond capacity and skip if it has already in output_.writer()
-  if ( first_index >= first_unacceptable_index || end_index <= unassembled_index_ || data.empty()
-       || avail_capacity == 0 ) {
-    if ( eof_idx_ == unassembled_index_ && unassembled_bytes_ == 0 ) {
-      output_.writer().close();
+  if ( not clip( first_index, data ) ) {
+    return;
+  }
+
+  // fast path: the next bytes of the stream, with nothing stored that could overlap or follow them
+  if ( first_index == writer().bytes_pushed() && unassembled_bytes_ == 0 ) {
+    ++stats_.fast_path_inserts;
+    if ( hole_opened_.has_value() ) { // the stored bytes past the hole were dropped under the limits
+      count( stats_.hole_fill_inserts, stats_.inserts - *hole_opened_ );
+      hole_opened_.reset();
     }
+    output_.writer().push( move( data ) );
     return;
   }
 
-  // 2. cut the substring to fit the capacity and leave out substring already in output_.writer()
+  ++stats_.slow_path_inserts;
+  count( stats_.reorder_distance, first_index - writer().bytes_pushed() );
+  if ( first_index > writer().bytes_pushed() && not hole_opened_.has_value() ) {
+    hole_opened_ = stats_.inserts;
+  }
+  store( first_index, move( data ) );
+  stats_.peak_bytes_pending = max( stats_.peak_bytes_pending, unassembled_bytes_ );
+}
+
+bool Reassembler::clip( uint64_t& first_index, string& data )
+{
+  // [) interval
+  const uint64_t unassembled_index = writer().bytes_pushed();
+  const uint64_t first_unacceptable_index = unassembled_index + writer().available_capacity();
+  const uint64_t end_index = first_index + data.size();
+
+  if ( first_index < unassembled_index ) {
+    stats_.duplicate_bytes += min( end_index, unassembled_index ) - first_index;
+  }
   if ( end_index > first_unacceptable_index ) {
-    data = data.substr( 0, first_unacceptable_index - first_index );
-    end_index = first_unacceptable_index;
+    stats_.beyond_capacity_bytes += end_index - max( first_index, first_unacceptable_index );
   }
 
-  if ( first_index < unassembled_index_ ) {
-    data = data.substr( unassembled_index_ - first_index );
-    first_index = unassembled_index_;
+  // discard data beyond capacity, and data that has already been pushed
+  if ( max( first_index, unassembled_index ) >= min( end_index, first_unacceptable_index ) ) {
+    return false;
   }
 
-  // 3. insert the substring into idx2substring_ and merge overlapping intervals
-  auto it = idx2substring_.lower_bound( first_index );
+  if ( end_index > first_unacceptable_index ) {
+    data.resize( first_unacceptable_index - first_index );
+  }
+  if ( first_index < unassembled_index ) {
+    data.erase( 0, unassembled_index - first_index );
+    first_index = unassembled_index;
+  }
+  return true;
+}
 
-  if ( it != idx2substring_.begin() && ( it == idx2substring_.end() || it->first > first_index ) ) {
-    --it;
+void Reassembler::store( uint64_t first_index, string&& data )
+{
+  if ( storage_ == Storage::Ring ) {
+    store_ring( first_index, data );
+    return;
   }
 
-  // merge
-  uint64_t new_start = first_index;
-  uint64_t new_end = end_index;
-  std::string new_data = data;
-  while ( it != idx2substring_.end() && it->first <= new_end ) {
-    uint64_t existing_start = it->first;
-    uint64_t existing_end = existing_start + it->second.size();
-    if ( existing_end >= new_start ) {
-      uint64_t slice_1 = 0;
-      if ( existing_start > new_start ) {
-        slice_1 = existing_start - new_start;
-      }
-      uint64_t slice_2 = std::min( new_data.size(), existing_end - new_start );
-      new_data = new_data.substr( 0, slice_1 ) + it->second + new_data.substr( slice_2 );
-      new_start = min( new_start, existing_start );
-      new_end = max( new_end, existing_end );
-      it = idx2substring_.erase( it );
-    } else {
-      ++it; // targeted on the first block;
+  uint64_t end_index = first_index + data.size();
+
+  // the piece starting at or before first_index already holds our prefix, or all of it
+  auto it = idx2substring_.upper_bound( first_index );
+  if ( it != idx2substring_.begin() ) {
+    const auto prev = std::prev( it );
+    const uint64_t prev_end = prev->first + prev->second.size();
+    if ( prev_end >= end_index ) {
+      stats_.duplicate_bytes += data.size();
+      return;
+    }
+    if ( prev_end > first_index ) {
+      stats_.duplicate_bytes += prev_end - first_index;
+      data.erase( 0, prev_end - first_index );
+      first_index = prev_end;
+    }
+  }
+
+  // pieces inside the new interval are superseded by it; a piece that runs past its end keeps the overlap
+  while ( it != idx2substring_.end() && it->first < end_index ) {
+    const uint64_t it_end = it->first + it->second.size();
+    if ( it_end > end_index ) {
+      stats_.duplicate_bytes += end_index - it->first;
+      data.resize( it->first - first_index );
+      end_index = it->first;
+      break;
+    }
+    stats_.duplicate_bytes += remove_piece( it ).size();
+  }
+  if ( data.empty() ) { // the pieces on either side held all of it
+    return;
+  }
+
+  enforce_limits( add_piece( it, first_index, move( data ) ) );
+}
+
+void Reassembler::flush()
+{
+  const uint64_t pushed_before = writer().bytes_pushed();
+  if ( storage_ == Storage::Ring ) {
+    flush_ring();
+  } else {
+    flush_map();
+  }
+
+  // the hole at the next index was filled; if more bytes are stored, there is a new hole after them
+  if ( hole_opened_.has_value() && writer().bytes_pushed() > pushed_before ) {
+    count( stats_.hole_fill_inserts, stats_.inserts - *hole_opened_ );
+    hole_opened_.reset();
+    if ( unassembled_bytes_ > 0 ) {
+      hole_opened_ = stats_.inserts;
+    }
+  }
+
+  if ( eof_idx_ == writer().bytes_pushed() && unassembled_bytes_ == 0 ) {
+    output_.writer().close();
+  }
+}
+
+void Reassembler::flush_map()
+{
+  auto it = idx2substring_.begin();
+  while ( it != idx2substring_.end() && it->first == writer().bytes_pushed() ) {
+    const uint64_t avail_capacity = writer().available_capacity();
+    if ( avail_capacity == 0 ) {
+      break;
+    }
+
+    string piece = remove_piece( it );
+    if ( piece.size() <= avail_capacity ) {
+      output_.writer().push( move( piece ) );
+      continue;
+    }
+
+    // the capacity shrank since this piece was stored: push what fits and keep the rest
+    string rest = piece.substr( avail_capacity );
+    piece.resize( avail_capacity );
+    output_.writer().push( move( piece ) );
+    store( writer().bytes_pushed(), move( rest ) );
+    break;
+  }
+}
+
+Reassembler::PieceMap::iterator Reassembler::add_piece( PieceMap::const_iterator hint,
+                                                        uint64_t first_index,
+                                                        string&& data )
+{
+  const size_t size = data.size();
+  const uint64_t memory = piece_memory( data );
+  const size_t pieces_before = idx2substring_.size();
+  const auto it = idx2substring_.emplace_hint( hint, first_index, move( data ) );
+  if ( idx2substring_.size() > pieces_before ) { // a piece already at first_index keeps its place
+    unassembled_bytes_ += size;
+    map_memory_ += memory;
+  }
+  return it;
+}
+
+string Reassembler::remove_piece( PieceMap::iterator& it )
+{
+  unassembled_bytes_ -= it->second.size();
+  map_memory_ -= piece_memory( it->second );
+  string piece = move( it->second );
+  it = idx2substring_.erase( it );
+  return piece;
+}
+
+uint64_t Reassembler::piece_memory( const string& piece )
+{
+  // a tree node (three pointers and a color) around the key and string, plus the string's own buffer
+  static constexpr uint64_t node_size = 4 * sizeof( void* ) + sizeof( PieceMap::value_type );
+  static constexpr uint64_t inline_capacity = string {}.capacity();
+  return node_size + ( piece.capacity() > inline_capacity ? piece.capacity() + 1 : 0 );
+}
+
+bool Reassembler::within_limits() const
+{
+  if ( limits_.max_fragments > 0 && idx2substring_.size() > limits_.max_fragments ) {
+    return false;
+  }
+  const double max_memory = limits_.max_overhead_ratio * static_cast<double>( unassembled_bytes_ );
+  return limits_.max_overhead_ratio <= 0 || idx2substring_.size() < 2
+         || static_cast<double>( map_memory_ ) <= max_memory;
+}
+
+void Reassembler::enforce_limits( PieceMap::iterator stored )
+{
+  if ( within_limits() ) {
+    return;
+  }
+
+  // first merge the new piece with any neighbours it touches, into one exactly-sized buffer; this loses nothing
+  auto first = stored;
+  if ( first != idx2substring_.begin() ) {
+    const auto prev = std::prev( first );
+    if ( prev->first + prev->second.size() == first->first ) {
+      first = prev;
     }
   }
+  auto last = std::next( stored );
+  if ( last != idx2substring_.end() && stored->first + stored->second.size() == last->first ) {
+    ++last;
+  }
 
-  idx2substring_[new_start] = new_data;
+  const uint64_t first_index = first->first;
+  string merged;
+  merged.reserve( std::prev( last )->first + std::prev( last )->second.size() - first_index );
+  for ( auto it = first; it != last; ) {
+    merged += remove_piece( it );
+    ++stats_.coalesced_fragments;
+  }
+  --stats_.coalesced_fragments; // one piece remains
+  add_piece( last, first_index, move( merged ) );
 
-  // push "available capacity" data to output_.writer()
+  // then drop the pieces furthest from the next needed byte, which would be the last to become useful
+  while ( not within_limits() ) {
+    auto it = std::prev( idx2substring_.end() );
+    ++stats_.dropped_fragments;
+    stats_.dropped_bytes += remove_piece( it ).size();
+  }
+}
+
+void Reassembler::store_ring( uint64_t first_index, const string& data )
+{
+  // the window never exceeds the capacity, so a ring of that size holds every acceptable byte
+  const uint64_t capacity = writer().capacity();
+  if ( ring_.size() < capacity ) {
+    resize_ring( ( capacity + 63 ) / 64 * 64 );
+  }
 
-  it = idx2substring_.begin();
-  if ( it->first == unassembled_index_ ) {
-    if ( it->second.size() <= avail_capacity ) {
-      output_.writer().push( it->second );
-      unassembled_index_ += it->second.size();
-      idx2substring_.erase( it );
+  // copy in the run up to the end of ring_, then the part that wraps around to the front
+  const uint64_t offset = first_index % ring_.size();
+  const uint64_t first_len = min( static_cast<uint64_t>( data.size() ), ring_.size() - offset );
+  ring_.replace( offset, first_len, data, 0, first_len );
+  ring_.replace( 0, data.size() - first_len, data, first_len );
+  const uint64_t newly_present = mark_present( offset, first_len ) + mark_present( 0, data.size() - first_len );
+  unassembled_bytes_ += newly_present;
+  stats_.duplicate_bytes += data.size() - newly_present;
+}
+
+void Reassembler::flush_ring()
+{
+  while ( not ring_.empty() && unassembled_bytes_ > 0 ) {
+    const uint64_t offset = writer().bytes_pushed() % ring_.size();
+    const uint64_t max_len = min( writer().available_capacity(), ring_.size() - offset );
+    const uint64_t len = present_run( offset, max_len );
+    if ( len == 0 ) {
+      break;
+    }
+
+    // clear the run's bits a word at a time, then push a copy of its bytes
+    for ( uint64_t i = offset; i < offset + len; ) {
+      const uint64_t bit = i % 64;
+      const uint64_t n = min( 64 - bit, offset + len - i );
+      present_[i / 64] &= ~( ( n == 64 ? ~uint64_t {} : ( uint64_t { 1 } << n ) - 1 ) << bit );
+      i += n;
+    }
+    unassembled_bytes_ -= len;
+    output_.writer().push( ring_.substr( offset, len ) );
+  }
+}
+
+void Reassembler::resize_ring( uint64_t size )
+{
+  string old_ring = exchange( ring_, string( size, '\0' ) );
+  vector<uint64_t> old_present = exchange( present_, vector<uint64_t>( size / 64 ) );
+  if ( old_ring.empty() || unassembled_bytes_ == 0 ) {
+    return;
+  }
+
+  // every stored byte lies in [bytes_pushed, bytes_pushed + old size), so its stream index can be recovered
+  const uint64_t base = writer().bytes_pushed();
+  for ( uint64_t index = base; index < base + old_ring.size(); ++index ) {
+    const uint64_t old_offset = index % old_ring.size();
+    if ( old_present[old_offset / 64] >> ( old_offset % 64 ) & 1 ) {
+      const uint64_t offset = index % size;
+      ring_[offset] = old_ring[old_offset];
+      present_[offset / 64] |= uint64_t { 1 } << ( offset % 64 );
+    }
+  }
+}
+
+uint64_t Reassembler::mark_present( uint64_t offset, uint64_t len )
+{
+  uint64_t newly_set = 0;
+  for ( uint64_t i = offset; i < offset + len; ) {
+    const uint64_t bit = i % 64;
+    const uint64_t n = min( 64 - bit, offset + len - i );
+    const uint64_t mask = ( n == 64 ? ~uint64_t {} : ( uint64_t { 1 } << n ) - 1 ) << bit;
+    newly_set += popcount( mask & ~present_[i / 64] );
+    present_[i / 64] |= mask;
+    i += n;
+  }
+  return newly_set;
+}
+
+uint64_t Reassembler::absent_run( uint64_t offset, uint64_t max_len ) const
+{
+  // count trailing zeros a word at a time until a set bit or max_len
+  uint64_t len = 0;
+  while ( len < max_len ) {
+    const uint64_t i = offset + len;
+    const uint64_t bit = i % 64;
+    const uint64_t zeros = min( static_cast<uint64_t>( countr_zero( present_[i / 64] >> bit ) ), 64 - bit );
+    len += zeros;
+    if ( zeros < 64 - bit ) {
+      break;
+    }
+  }
+  return min( len, max_len );
+}
+
+uint64_t Reassembler::present_run( uint64_t offset, uint64_t max_len ) const
+{
+  // count trailing ones a word at a time until a zero bit or max_len
+  uint64_t len = 0;
+  while ( len < max_len ) {
+    const uint64_t i = offset + len;
+    const uint64_t bit = i % 64;
+    const uint64_t ones = countr_one( present_[i / 64] >> bit );
+    len += min( ones, 64 - bit );
+    if ( ones < 64 - bit ) {
+      break;
+    }
+  }
+  return min( len, max_len );
+}
+
+vector<pair<uint64_t, uint64_t>> Reassembler::received_blocks( size_t max_blocks ) const
+{
+  vector<pair<uint64_t, uint64_t>> blocks;
+  if ( max_blocks == 0 ) {
+    return blocks;
+  }
+
+  // extend the last block if this run touches it, or start a new one
+  auto add_run = [&]( uint64_t first, uint64_t end ) {
+    if ( not blocks.empty() && blocks.back().second == first ) {
+      blocks.back().second = end;
+      return true;
+    }
+    if ( blocks.size() == max_blocks ) {
+      return false;
+    }
+    blocks.emplace_back( first, end );
+    return true;
+  };
+
+  if ( storage_ == Storage::Map ) {
+    for ( const auto& [first, piece] : idx2substring_ ) {
+      if ( not add_run( first, first + piece.size() ) ) {
+        break;
+      }
+    }
+    return blocks;
+  }
+
+  // Ring: alternate runs of absent and present bytes from the next index, stopping where the ring wraps
+  // around to it again
+  if ( ring_.empty() || unassembled_bytes_ == 0 ) {
+    return blocks;
+  }
+  const uint64_t end = writer().bytes_pushed() + ring_.size();
+  for ( uint64_t index = writer().bytes_pushed(); index < end; ) {
+    const uint64_t offset = index % ring_.size();
+    const uint64_t max_len = min( end - index, ring_.size() - offset );
+    const uint64_t absent = absent_run( offset, max_len );
+    if ( absent < max_len ) {
+      const uint64_t present = present_run( offset + absent, max_len - absent );
+      if ( not add_run( index + absent, index + absent + present ) ) {
+        break;
+      }
+      index += absent + present;
     } else {
-      output_.writer().push( it->second.substr( 0, avail_capacity ) );
-      unassembled_index_ += avail_capacity;
-      idx2substring_[unassembled_index_] = it->second.substr( avail_capacity );
-      idx2substring_.erase( it );
+      index += absent;
     }
   }
-  // re-calculate unassembled_bytes_
-  unassembled_bytes_ = 0;
-  for ( auto& tmp : idx2substring_ ) {
-    unassembled_bytes_ += tmp.second.size();
+  return blocks;
+}
+
+uint64_t Reassembler::memory_usage() const
+{
+  if ( storage_ == Storage::Ring ) {
+    return ring_.capacity() + present_.capacity() * sizeof( uint64_t );
   }
+  return map_memory_;
+}
 
-  if ( eof_idx_ == unassembled_index_ && unassembled_bytes_ == 0 ) {
-    output_.writer().close();
+uint64_t Reassembler::fragment_count() const
+{
+  if ( storage_ == Storage::Map ) {
+    return idx2substring_.size();
   }
+
+  // count the first bit of each run of set bits (a run may wrap around the end of the ring)
+  uint64_t runs = 0;
+  uint64_t carry = present_.empty() ? 0 : present_.back() >> 63;
+  for ( const uint64_t word : present_ ) {
+    runs += popcount( word & ~( word << 1 | carry ) );
+    carry = word >> 63;
+  }
+  return runs;
+}
+
+string Reassembler::Stats::to_string() const
+{
+  ostringstream out;
+  out << inserts << " inserts (" << fast_path_inserts << " in order, " << slow_path_inserts << " stored), "
+      << duplicate_bytes << " duplicate bytes, " << beyond_capacity_bytes << " bytes beyond capacity, "
+      << peak_bytes_pending << " peak bytes pending";
+  if ( dropped_fragments > 0 || coalesced_fragments > 0 ) {
+    out << ", " << dropped_fragments << " fragments (" << dropped_bytes << " bytes) dropped, "
+        << coalesced_fragments << " coalesced";
+  }
+
+  // print each non-empty bucket as its range of values
+  auto print = [&]( const string& name, const Histogram& histogram ) {
+    out << "\n  " << name << ":";
+    for ( size_t i = 0; i < histogram.size(); ++i ) {
+      if ( histogram[i] > 0 ) {
+        const uint64_t low = i == 0 ? 0 : uint64_t { 1 } << ( i - 1 );
+        const string high = i + 1 == histogram.size() ? "inf" : std::to_string( i == 0 ? 1 : 2 * low );
+        out << " [" << low << "," << high << "):" << histogram[i];
+      }
+    }
+  };
+  print( "reorder distance (bytes)", reorder_distance );
+  print( "inserts to fill a hole", hole_fill_inserts );
+  return out.str();
 }
 
 uint64_t Reassembler::bytes_pending() const
@@ -1,15 +1,30 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <map>
+#include <optional>
+#include <span>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "byte_stream.hh"
 
 class Reassembler
 {
 public:
+  // How the Reassembler holds bytes that arrived ahead of a gap
+  enum class Storage
+  {
+    Map,  // non-overlapping pieces in a std::map keyed by stream index
+    Ring, // a ring buffer sized to the stream's capacity, plus a bitmap of which bytes are present
+  };
+
   // Construct Reassembler to write into given ByteStream.
-  explicit Reassembler( ByteStream&& output ) : output_( std::move( output ) ) {}
+  explicit Reassembler( ByteStream&& output, Storage storage = Storage::Map )
+    : output_( std::move( output ) ), storage_( storage )
+  {}
 
   /*
    * Insert a new substring to be reassembled into a ByteStream.
@@ -33,9 +48,65 @@ public:
    */
   void insert( uint64_t first_index, std::string data, bool is_last_substring );
 
+  // One substring for insert_batch()
+  struct Substring
+  {
+    uint64_t first_index {};
+    std::string data {};
+    bool is_last_substring {};
+  };
+
+  /*
+   * Insert a burst of substrings at once. They are sorted by index first (so a burst that arrived
+   * out of order within itself is pushed in order, without being stored), and stored substrings are
+   * flushed to the output once at the end. The strings are moved from, and `substrings` is reordered.
+   */
+  void insert_batch( std::span<Substring> substrings );
+
   // How many bytes are stored in the Reassembler itself?
   uint64_t bytes_pending() const;
 
+  // The first `max_blocks` runs of stored bytes beyond the next index, as [first, end) stream indices
+  std::vector<std::pair<uint64_t, uint64_t>> received_blocks( size_t max_blocks ) const;
+
+  // Estimated heap memory held for pending bytes: map nodes and string buffers, or the ring and its bitmap
+  uint64_t memory_usage() const;
+  // How many separate runs of pending bytes are stored
+  uint64_t fragment_count() const;
+
+  // Bounds on what Map storage may hold, enforced after each store; zero means unbounded
+  struct Limits
+  {
+    uint64_t max_fragments {};         // most pieces stored at once
+    double max_overhead_ratio {}; // most memory_usage() per pending byte, while two or more pieces are stored
+  };
+  void set_limits( const Limits& limits ) { limits_ = limits; }
+
+  // Counters of how inserts were handled, cheap enough to keep on all the time
+  struct Stats
+  {
+    // histogram bucket i counts values whose bit width is i: 0, 1, [2, 4), [4, 8), ..., and the rest in the last
+    static constexpr size_t HISTOGRAM_BUCKETS = 32;
+    using Histogram = std::array<uint64_t, HISTOGRAM_BUCKETS>;
+
+    uint64_t inserts {};               // substrings offered, including empty and unacceptable ones
+    uint64_t fast_path_inserts {};     // arrived in order with nothing pending, and moved straight to the output
+    uint64_t slow_path_inserts {};     // had to go through storage (or found earlier bytes already stored)
+    uint64_t coalesced_fragments {};   // pieces merged with a touching neighbour to get back within the limits
+    uint64_t dropped_fragments {};     // pieces discarded to get back within the limits
+    uint64_t dropped_bytes {};         // ... and the bytes they held, which the peer will have to resend
+    uint64_t duplicate_bytes {};       // bytes discarded because they were already pushed or stored
+    uint64_t beyond_capacity_bytes {}; // bytes discarded because they lay past the available capacity
+    uint64_t peak_bytes_pending {};    // most bytes ever stored at once
+    Histogram reorder_distance {};     // for slow-path inserts: how many bytes past the next index they started
+    // for each hole at the next index: how many inserts it took to fill. The Reassembler has no clock, so this
+    // count of the inserts in between stands in for the time a hole stays open.
+    Histogram hole_fill_inserts {};
+
+    std::string to_string() const;
+  };
+  const Stats& stats() const { return stats_; }
+
   // Access output stream reader
   Reader& reader() { return output_.reader(); }
   const Reader& reader() const { return output_.reader(); }
@@ -44,8 +115,41 @@ public:
   const Writer& writer() const { return output_.writer(); }
 
 private:
+  // Clip one substring, then push it (in order, nothing pending) or store it
+  void place( uint64_t first_index, std::string&& data, bool is_last_substring );
+  // Trim `data` to the window [next index, first unacceptable index); returns false if nothing is left
+  bool clip( uint64_t& first_index, std::string& data );
+  // Store the bytes of `data` that no stored piece already holds, keeping the pieces non-overlapping
+  void store( uint64_t first_index, std::string&& data );
+  // Push every stored piece that starts at the next index, then close the stream if it is complete
+  void flush();
+  void flush_map();
+
+  // Map storage: every piece enters and leaves idx2substring_ through these, which keep the accounting
+  using PieceMap = std::map<uint64_t, std::string>;
+  PieceMap::iterator add_piece( PieceMap::const_iterator hint, uint64_t first_index, std::string&& data );
+  std::string remove_piece( PieceMap::iterator& it ); // advances `it` past the removed piece
+  static uint64_t piece_memory( const std::string& piece );
+  bool within_limits() const;
+  void enforce_limits( PieceMap::iterator stored );
+
+  // Ring storage: byte i of the stream lives at ring_[i % ring_.size()], and is present if its bit is set
+  void store_ring( uint64_t first_index, const std::string& data );
+  void flush_ring();
+  void resize_ring( uint64_t size ); // re-place the stored bytes in a ring of `size` bytes (a multiple of 64)
+  uint64_t mark_present( uint64_t offset, uint64_t len ); // set bits, returning how many were newly set
+  uint64_t present_run( uint64_t offset, uint64_t max_len ) const; // length of the run of set bits at offset
+  uint64_t absent_run( uint64_t offset, uint64_t max_len ) const;  // length of the run of clear bits at offset
+
   ByteStream output_;                                // the Reassembler writes to this ByteStream
-  std::map<uint64_t, std::string> idx2substring_ {}; // map from stream index to substrings
+  Storage storage_;
+  PieceMap idx2substring_ {};                        // Map: non-overlapping pieces, keyed by stream index
+  uint64_t map_memory_ { 0 };                        // Map: piece_memory() summed over idx2substring_
+  std::string ring_ {};                              // Ring: stored bytes, sized to at least the capacity
+  std::vector<uint64_t> present_ {};                 // Ring: one bit per byte of ring_
   uint64_t unassembled_bytes_ { 0 };                 // bytes stored in reassembler
   uint64_t eof_idx_ { UINT64_MAX };
+  Limits limits_ {};
+  Stats stats_ {};
+  std::optional<uint64_t> hole_opened_ {}; // stats_.inserts when the current hole at the next index opened
 };
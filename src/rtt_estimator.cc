@@ -0,0 +1,31 @@
+#include "rtt_estimator.hh"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+RTTEstimator::RTTEstimator( uint64_t initial_RTO_ms, uint64_t min_RTO_ms, uint64_t max_RTO_ms )
+  : min_RTO_ms_( min_RTO_ms ), max_RTO_ms_( max( min_RTO_ms, max_RTO_ms ) ), RTO_ms_( initial_RTO_ms )
+{}
+
+void RTTEstimator::sample( uint64_t rtt_ms )
+{
+  const double rtt = static_cast<double>( rtt_ms );
+  if ( srtt_ms_.has_value() ) {
+    rttvar_ms_ = ( 1 - BETA ) * rttvar_ms_ + BETA * abs( *srtt_ms_ - rtt ); // uses SRTT before this sample
+    srtt_ms_ = ( 1 - ALPHA ) * *srtt_ms_ + ALPHA * rtt;
+  } else {
+    srtt_ms_ = rtt;
+    rttvar_ms_ = rtt / 2;
+  }
+  ++samples_;
+
+  const double RTO = *srtt_ms_ + max( CLOCK_GRANULARITY_MS, 4 * rttvar_ms_ );
+  RTO_ms_ = clamp( static_cast<uint64_t>( ceil( RTO ) ), min_RTO_ms_, max_RTO_ms_ );
+}
+
+void RTTEstimator::back_off()
+{
+  RTO_ms_ = min( 2 * RTO_ms_, max_RTO_ms_ );
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+/*
+ * Round-trip time estimation and the retransmission timeout it implies (RFC 6298). Each RTT sample moves
+ * the smoothed RTT (SRTT) an eighth of the way toward it, and the RTT variation (RTTVAR) a quarter of the
+ * way toward the sample's distance from SRTT. The RTO is SRTT + 4 * RTTVAR, kept within [min, max], and
+ * doubles (up to the maximum) each time the timer expires. Until the first sample, the RTO is the initial one.
+ */
+class RTTEstimator
+{
+public:
+  RTTEstimator( uint64_t initial_RTO_ms, uint64_t min_RTO_ms, uint64_t max_RTO_ms );
+
+  // A segment sent `rtt_ms` ago was acknowledged (or SACKed), and was never retransmitted
+  void sample( uint64_t rtt_ms );
+
+  // The timer expired: double the RTO (up to the maximum) until the next sample
+  void back_off();
+
+  uint64_t RTO_ms() const { return RTO_ms_; }
+  std::optional<double> srtt_ms() const { return srtt_ms_; } // no value before the first sample
+  double rttvar_ms() const { return rttvar_ms_; }
+  uint64_t samples() const { return samples_; }
+
+private:
+  static constexpr double ALPHA = 1.0 / 8;
+  static constexpr double BETA = 1.0 / 4;
+  static constexpr double CLOCK_GRANULARITY_MS = 1; // the resolution of tick()
+
+  uint64_t min_RTO_ms_;
+  uint64_t max_RTO_ms_;
+  uint64_t RTO_ms_;
+  std::optional<double> srtt_ms_ {};
+  double rttvar_ms_ {};
+  uint64_t samples_ {};
+};
@@ -0,0 +1,85 @@
+#include "sack_scoreboard.hh"
+
+#include <algorithm>
+#include <iterator>
+
+using namespace std;
+
+void SACKScoreboard::add( uint64_t first, uint64_t end )
+{
+  if ( first >= end ) {
+    return;
+  }
+
+  // absorb every range that overlaps or touches [first, end)
+  auto it = ranges_.upper_bound( first );
+  if ( it != ranges_.begin() && prev( it )->second >= first ) {
+    --it;
+  }
+  while ( it != ranges_.end() && it->first <= end ) {
+    first = min( first, it->first );
+    end = max( end, it->second );
+    sacked_bytes_ -= it->second - it->first;
+    it = ranges_.erase( it );
+  }
+  ranges_.emplace_hint( it, first, end );
+  sacked_bytes_ += end - first;
+}
+
+void SACKScoreboard::acknowledge( uint64_t ackno )
+{
+  while ( not ranges_.empty() && ranges_.begin()->first < ackno ) {
+    auto node = ranges_.extract( ranges_.begin() );
+    sacked_bytes_ -= node.mapped() - node.key();
+    if ( node.mapped() > ackno ) {
+      node.key() = ackno;
+      sacked_bytes_ += node.mapped() - node.key();
+      ranges_.insert( move( node ) );
+      break;
+    }
+  }
+  retransmitted_.erase( retransmitted_.begin(), retransmitted_.lower_bound( ackno ) );
+}
+
+void SACKScoreboard::clear()
+{
+  ranges_.clear();
+  sacked_bytes_ = 0;
+  retransmitted_.clear();
+}
+
+bool SACKScoreboard::holds( uint64_t first, uint64_t end ) const
+{
+  auto it = ranges_.upper_bound( first );
+  return it != ranges_.begin() && prev( it )->second >= end;
+}
+
+SACKScoreboard::Scan::Scan( const SACKScoreboard& scoreboard, size_t mss )
+  : ranges_( scoreboard.ranges_ )
+  , above_( ranges_.begin() )
+  , bytes_above_( scoreboard.sacked_bytes_ )
+  , ranges_above_( ranges_.size() )
+  , mss_( mss )
+{}
+
+void SACKScoreboard::Scan::advance( uint64_t end )
+{
+  for ( ; above_ != ranges_.end() && above_->first < end; ++above_ ) {
+    bytes_above_ -= above_->second - above_->first;
+    --ranges_above_;
+  }
+}
+
+bool SACKScoreboard::Scan::holds( uint64_t first, uint64_t end )
+{
+  // the only range that can hold the segment is the last one to begin below its end
+  advance( end );
+  return above_ != ranges_.begin() && prev( above_ )->first <= first && prev( above_ )->second >= end;
+}
+
+bool SACKScoreboard::Scan::is_lost( uint64_t end )
+{
+  advance( end );
+  constexpr size_t threshold = CongestionControl::DUPLICATE_ACK_THRESHOLD;
+  return ranges_above_ >= threshold || bytes_above_ > ( threshold - 1 ) * mss_;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "congestion_control.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+
+/*
+ * What the peer's selective acknowledgments (RFC 2018) say it holds beyond the ackno, in absolute sequence
+ * numbers, and which of the holes between them the sender has already resent. A hole counts as lost, as in
+ * RFC 6675, once more than (DupThresh - 1) * MSS bytes above it are SACKed, or DupThresh separate SACKed
+ * ranges lie above it.
+ */
+class SACKScoreboard
+{
+public:
+  // The peer holds [first, end)
+  void add( uint64_t first, uint64_t end );
+
+  // Everything below `ackno` is acknowledged cumulatively: forget it
+  void acknowledge( uint64_t ackno );
+
+  // The timer expired: the peer may have discarded what it SACKed (RFC 2018 section 8), so forget it all
+  void clear();
+
+  void mark_retransmitted( uint64_t first ) { retransmitted_.insert( first ); }
+  bool retransmitted( uint64_t first ) const { return retransmitted_.contains( first ); }
+
+  bool holds( uint64_t first, uint64_t end ) const; // does the peer hold all of [first, end)?
+
+  bool empty() const { return ranges_.empty(); }
+  uint64_t highest_sacked() const { return ranges_.empty() ? 0 : ranges_.rbegin()->second; }
+  uint64_t sacked_bytes() const { return sacked_bytes_; }
+
+  // A walk up the sequence space, asked about each segment in turn. It keeps count of the SACKed bytes and
+  // ranges above the segment, as RFC 6675's IsLost() does, so a walk over every outstanding segment takes
+  // time linear in the segments and ranges rather than their product.
+  class Scan
+  {
+  public:
+    Scan( const SACKScoreboard& scoreboard, size_t mss );
+
+    // About the segment [first, end), which must not end below the one asked about before
+    bool holds( uint64_t first, uint64_t end ); // does the peer hold all of it?
+    bool is_lost( uint64_t end );               // is it lost, if the peer does not?
+
+  private:
+    void advance( uint64_t end ); // pass every range that begins below `end`
+
+    const std::map<uint64_t, uint64_t>& ranges_;
+    std::map<uint64_t, uint64_t>::const_iterator above_; // the first range beginning at or past the segment end
+    uint64_t bytes_above_;
+    size_t ranges_above_;
+    size_t mss_;
+  };
+
+  Scan scan( size_t mss ) const { return { *this, mss }; }
+
+private:
+  std::map<uint64_t, uint64_t> ranges_ {}; // first => end, disjoint and not touching
+  uint64_t sacked_bytes_ {};
+  std::set<uint64_t> retransmitted_ {}; // first seqnos of holes resent since the last timeout
+};
@@ -20,7 +20,14 @@ void TCPReceiver::receive( TCPSenderMessage message )
   // write message into reassembler
 
   uint64_t absolute_seqno = message.seqno.unwrap( zero_point_, writer().bytes_pushed() );
-  reassembler_.insert( absolute_seqno - 1 + message.SYN, message.payload, message.FIN );
+  reassembler_.insert( absolute_seqno - 1 + message.SYN, move( message.payload ), message.FIN );
+
+  // the application has kept up with a full window since the last change, so let the window grow
+  const uint64_t capacity = reader().capacity();
+  if ( capacity < autotune_limit_ && reader().bytes_popped() >= autotune_mark_ + capacity ) {
+    reader().set_capacity( min( 2 * capacity, autotune_limit_ ) );
+    autotune_mark_ = reader().bytes_popped();
+  }
 }
 
 TCPReceiverMessage TCPReceiver::send() const
@@ -37,6 +44,11 @@ TCPReceiverMessage TCPReceiver::send() const
       absolute_ack_no++;
     }
     recv_msg.ackno = Wrap32::wrap( absolute_ack_no, zero_point_ );
+
+    // stream index i is absolute sequence number i + 1, after the SYN
+    for ( const auto& [first, end] : reassembler_.received_blocks( sack_blocks_ ) ) {
+      recv_msg.sack.emplace_back( Wrap32::wrap( first + 1, zero_point_ ), Wrap32::wrap( end + 1, zero_point_ ) );
+    }
   } else {
     recv_msg.ackno = std::nullopt;
   }
@@ -19,6 +19,18 @@ public:
   // The TCPReceiver sends TCPReceiverMessages to the peer's TCPSender.
   TCPReceiverMessage send() const;
 
+  /*
+   * Receive-buffer autotuning: each time the application drains a full window's worth of bytes,
+   * double the inbound stream's capacity (and so the advertised window), up to `max_capacity`.
+   */
+  void set_autotune_limit( uint64_t max_capacity ) { autotune_limit_ = max_capacity; }
+
+  // Bound the memory the Reassembler spends on out-of-order fragments
+  void set_reassembler_limits( const Reassembler::Limits& limits ) { reassembler_.set_limits( limits ); }
+
+  // Report up to `max_blocks` SACK blocks in each TCPReceiverMessage (zero, the default, reports none)
+  void set_sack_blocks( size_t max_blocks ) { sack_blocks_ = max_blocks; }
+
   // Access the output (only Reader is accessible non-const)
   const Reassembler& reassembler() const { return reassembler_; }
   Reader& reader() { return reassembler_.reader(); }
@@ -29,4 +41,7 @@ private:
   Reassembler reassembler_;
   Wrap32 zero_point_ { 0 };
   bool received_syn_ { false };
+  uint64_t autotune_limit_ { 0 };
+  uint64_t autotune_mark_ { 0 }; // bytes_popped() when the capacity last changed
+  size_t sack_blocks_ { 0 };
 };
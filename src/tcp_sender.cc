@@ -1,6 +1,8 @@
 #include "tcp_sender.hh"
 #include "tcp_config.hh"
 
+#include <sstream>
+
 using namespace std;
 
 uint64_t TCPSender::sequence_numbers_in_flight() const
@@ -15,8 +17,23 @@ uint64_t TCPSender::consecutive_retransmissions() const
 
 void TCPSender::push( const TransmitFunction& transmit )
 {
-  uint16_t corrected_window_size = window_size_ == 0 ? 1 : window_size_;
-  while ( static_cast<uint64_t>( corrected_window_size ) > sequence_numbers_in_flight() ) {
+  if ( retransmit_due_ ) {
+    retransmit_due_ = false;
+    if ( !outstanding_.empty() ) {
+      retransmit( outstanding_.begin()->second, transmit );
+      ++stats_.fast_retransmissions;
+    }
+  }
+
+  const uint64_t corrected_window_size = send_window();
+  if ( scoreboard_ && !scoreboard_->empty() ) {
+    resend_lost_holes( corrected_window_size, transmit );
+  }
+  const bool paced = pacing_rate() > 0;
+  while ( corrected_window_size > sequence_numbers_in_flight() ) {
+    if ( paced && !pacing_bucket_.ready() ) {
+      break; // tick() sends more once the bucket refills
+    }
     auto message = make_empty_message();
     if ( message.RST ) {
       transmit( message );
@@ -28,13 +45,24 @@ void TCPSender::push( const TransmitFunction& transmit )
       is_syn_ = true;
     }
     // get maximum payload size
-    uint64_t max_packet_size = static_cast<uint64_t>( corrected_window_size ) - sequence_numbers_in_flight();
-    uint64_t max_payload_size_ = min( max_packet_size, TCPConfig::MAX_PAYLOAD_SIZE );
+    uint64_t max_packet_size = corrected_window_size - sequence_numbers_in_flight();
+    uint64_t max_payload_size_ = min( max_packet_size, static_cast<uint64_t>( mss_ ) );
+
+    // an MTU probe is a full segment of the probe size, so only send one when that much data is waiting
+    const uint64_t probe_size = next_probe_size();
+    const bool is_probe = probe_size > 0 && !message.SYN && max_packet_size >= probe_size
+                          && reader().bytes_buffered() >= probe_size;
+    if ( is_probe ) {
+      max_payload_size_ = probe_size;
+    }
+    if ( !message.SYN && hold_small_segment( max_payload_size_ ) ) {
+      break;
+    }
     while ( message.sequence_length() < max_payload_size_ && reader().bytes_buffered() ) {
-      uint64_t len = min( max_payload_size_ - message.sequence_length(), reader().bytes_buffered() );
-      auto peeked_data = reader().peek();
-      message.payload.append( peeked_data.substr( 0, len ) );
-      input_.reader().pop( len );
+      // peek() may return less than bytes_buffered() when the data wraps around the ring
+      auto peeked_data = reader().peek().substr( 0, max_payload_size_ - message.sequence_length() );
+      message.payload.append( peeked_data );
+      input_.reader().pop( peeked_data.size() );
     }
     // set FIN flag
     if ( !is_fin_ && reader().is_finished() && message.sequence_length() < max_packet_size ) {
@@ -45,8 +73,19 @@ void TCPSender::push( const TransmitFunction& transmit )
       break;
     }
     transmit( message );
-    send_queue_.emplace( message );
-    send_cnt_ += message.sequence_length();
+    if ( is_probe ) {
+      probe_seqno_ = send_cnt_;
+    }
+    if ( rtt_estimator_ && !timed_seqno_.has_value() ) {
+      timed_seqno_ = send_cnt_;
+      timed_since_ms_ = now_ms_;
+    }
+    const uint64_t length = message.sequence_length();
+    outstanding_.emplace_hint( outstanding_.end(), send_cnt_, move( message ) );
+    send_cnt_ += length;
+    if ( paced ) {
+      pacing_bucket_.take( length );
+    }
     if ( !is_timer_on ) {
       is_timer_on = true;
       timer_ = 0;
@@ -55,6 +94,9 @@ void TCPSender::push( const TransmitFunction& transmit )
       break;
     }
   }
+  if ( reader().bytes_buffered() == 0 ) {
+    held_since_ms_.reset();
+  }
 }
 
 TCPSenderMessage TCPSender::make_empty_message() const
@@ -67,6 +109,7 @@ TCPSenderMessage TCPSender::make_empty_message() const
 
 void TCPSender::receive( const TCPReceiverMessage& msg )
 {
+  const uint16_t previous_window_size = window_size_;
   window_size_ = msg.window_size;
   if ( msg.RST ) {
     input_.set_error();
@@ -74,45 +117,297 @@ void TCPSender::receive( const TCPReceiverMessage& msg )
   }
 
   if ( msg.ackno.has_value() ) {
+    const Wrap32 ackno = msg.ackno.value();
 
-    uint64_t absolute_ackno = msg.ackno.value().unwrap( isn_, send_cnt_ );
+    // an ackno past everything sent so far is bogus
+    if ( ackno > Wrap32::wrap( send_cnt_, isn_ ) ) {
+      return;
+    }
 
-    while ( !send_queue_.empty() ) {
-      if ( absolute_ackno > send_cnt_ ) {
-        break;
+    // release the segments the ackno covers entirely, oldest first, without touching the rest
+    const uint64_t absolute_ackno = ackno.unwrap( isn_, send_cnt_ );
+    const uint64_t previous_ack_cnt = ack_cnt_;
+    auto it = outstanding_.begin();
+    while ( it != outstanding_.end() && it->first + it->second.sequence_length() <= absolute_ackno ) {
+      if ( probe_seqno_ == it->first ) { // the probe got through: the path takes segments this large
+        mss_ = it->second.payload.size();
+        probe_seqno_.reset();
+        if ( congestion_control_ ) {
+          congestion_control_->set_mss( mss_ );
+        }
       }
-
-      auto cur_msg = send_queue_.front();
-      uint64_t msg_seqno = cur_msg.seqno.unwrap( isn_, send_cnt_ );
-
-      if ( msg_seqno + cur_msg.sequence_length() > absolute_ackno ) {
-        break;
+      if ( rtt_estimator_ && timed_seqno_ == it->first ) {
+        rtt_estimator_->sample( now_ms_ - timed_since_ms_ );
+        timed_seqno_.reset();
       }
-      ack_cnt_ += cur_msg.sequence_length();
-      send_queue_.pop();
-      current_RTO_ms_ = initial_RTO_ms_;
+      ack_cnt_ += it->second.sequence_length();
+      it = outstanding_.erase( it );
+      current_RTO_ms_ = rtt_estimator_ ? rtt_estimator_->RTO_ms() : initial_RTO_ms_;
       timer_ = 0;
       retx_attempts_ = 0;
 
-      if ( send_queue_.empty() ) {
+      if ( outstanding_.empty() ) {
         is_timer_on = false;
       }
     }
+
+    if ( scoreboard_ ) {
+      scoreboard_->acknowledge( absolute_ackno );
+      for ( const auto& [left, right] : msg.sack ) {
+        const uint64_t first = left.unwrap( isn_, send_cnt_ );
+        const uint64_t end = right.unwrap( isn_, send_cnt_ );
+        if ( first >= absolute_ackno && end <= send_cnt_ ) { // ignore blocks that make no sense
+          scoreboard_->add( first, end );
+        }
+      }
+
+      // a SACK of the timed segment is a valid sample, even while a hole below holds back its ACK
+      const auto timed = timed_seqno_.has_value() ? outstanding_.find( *timed_seqno_ ) : outstanding_.end();
+      if ( rtt_estimator_ && timed != outstanding_.end()
+           && scoreboard_->holds( timed->first, timed->first + timed->second.sequence_length() ) ) {
+        rtt_estimator_->sample( now_ms_ - timed_since_ms_ );
+        timed_seqno_.reset();
+        current_RTO_ms_ = rtt_estimator_->RTO_ms();
+      }
+    }
+
+    if ( ack_cnt_ > previous_ack_cnt ) {
+      duplicate_acks_ = 0;
+      // the SYN is not data, so acknowledging it does not grow the congestion window
+      const uint64_t acked = ack_cnt_ - previous_ack_cnt - ( previous_ack_cnt == 0 );
+      if ( congestion_control_ && acked > 0 ) {
+        retransmit_due_ |= congestion_control_->on_ack( absolute_ackno, acked, now_ms_ );
+      }
+    } else if ( !outstanding_.empty() && absolute_ackno == ack_cnt_ && msg.window_size == previous_window_size ) {
+      ++stats_.duplicate_acks;
+      ++duplicate_acks_;
+      if ( congestion_control_ ) {
+        retransmit_due_
+          |= congestion_control_->on_duplicate_ack( sequence_numbers_in_flight(), send_cnt_, now_ms_ );
+      } else if ( fast_retransmit_ && duplicate_acks_ == CongestionControl::DUPLICATE_ACK_THRESHOLD ) {
+        retransmit_due_ = true;
+      }
+    }
   }
 }
 
 void TCPSender::tick( uint64_t ms_since_last_tick, const TransmitFunction& transmit )
 {
   timer_ += ms_since_last_tick;
+  now_ms_ += ms_since_last_tick;
+  const double rate = pacing_rate();
+  if ( rate > 0 ) {
+    pacing_bucket_.refill( rate, ms_since_last_tick, 2 * mss_ );
+  }
 
   if ( timer_ >= current_RTO_ms_ ) {
-    if ( !send_queue_.empty() ) {
-      transmit( send_queue_.front() );
+    if ( !outstanding_.empty() && probe_seqno_ == outstanding_.begin()->first ) {
+      // a lost probe says the path is too narrow, not congested: no backoff, and not a retransmission
+      resend_lost_probe( transmit );
+      timer_ = 0;
+    } else if ( !outstanding_.empty() ) {
+      if ( scoreboard_ ) {
+        scoreboard_->clear();
+      }
+      retransmit( outstanding_.begin()->second, transmit );
+      ++stats_.timeout_retransmissions;
       if ( window_size_ > 0 ) { // if zero: means receiver's window is full, should not resend now.
         retx_attempts_++;
-        current_RTO_ms_ *= 2;
+        if ( rtt_estimator_ ) {
+          rtt_estimator_->back_off();
+          current_RTO_ms_ = rtt_estimator_->RTO_ms();
+        } else {
+          current_RTO_ms_ *= 2;
+        }
+        if ( congestion_control_ ) {
+          congestion_control_->on_timeout( sequence_numbers_in_flight(), send_cnt_, now_ms_ );
+        }
       }
       timer_ = 0;
     }
   }
+
+  // carry on with whatever push() left for the bucket or corked, once the connection has started
+  if ( ( rate > 0 || cork_expired() ) && send_cnt_ > 0 && !input_.has_error() ) {
+    push( transmit );
+  }
+}
+
+void TCPSender::set_congestion_control( unique_ptr<CongestionControl> congestion_control )
+{
+  congestion_control_ = move( congestion_control );
+}
+
+void TCPSender::configure( const TCPConfig& config )
+{
+  set_mss( config.mss );
+  set_mtu_probing( config.probe_mss );
+  set_congestion_control( CongestionControl::make( config.congestion_control, config.mss ) );
+  set_rtt_estimation( config.min_rto, config.max_rto );
+  set_fast_retransmit( config.fast_retransmit );
+  set_selective_retransmit( config.sack_retransmit );
+  set_pacing( config.pacing_rate, config.pacing );
+  set_coalescing( config.coalescing );
+}
+
+void TCPSender::set_rtt_estimation( uint64_t min_RTO_ms, uint64_t max_RTO_ms )
+{
+  rtt_estimator_.reset();
+  timed_seqno_.reset(); // a measurement in progress belongs to the old estimator
+  if ( min_RTO_ms > 0 ) {
+    rtt_estimator_.emplace( initial_RTO_ms_, min_RTO_ms, max_RTO_ms );
+  }
+}
+
+void TCPSender::retransmit( const TCPSenderMessage& message, const TransmitFunction& transmit )
+{
+  // an ACK cannot tell which transmission it answers, so a resent segment makes no RTT sample; nor, without
+  // SACK, does one sent after the hole, whose ACK waits for the hole to be filled
+  const uint64_t seqno = message.seqno.unwrap( isn_, send_cnt_ );
+  if ( !scoreboard_ || ( timed_seqno_ >= seqno && timed_seqno_ < seqno + message.sequence_length() ) ) {
+    timed_seqno_.reset();
+  }
+  if ( scoreboard_ ) {
+    scoreboard_->mark_retransmitted( seqno );
+  }
+  transmit( message );
+}
+
+void TCPSender::set_selective_retransmit( bool enabled )
+{
+  scoreboard_.reset();
+  if ( enabled ) {
+    scoreboard_.emplace();
+  }
+}
+
+void TCPSender::resend_lost_holes( uint64_t window, const TransmitFunction& transmit )
+{
+  // RFC 6675's pipe: what is still in the network, where a lost hole has left it until it is resent
+  uint64_t pipe = 0;
+  SACKScoreboard::Scan in_flight = scoreboard_->scan( mss_ );
+  for ( const auto& [seqno, message] : outstanding_ ) {
+    const uint64_t end = seqno + message.sequence_length();
+    if ( !in_flight.holds( seqno, end ) && ( !in_flight.is_lost( end ) || scoreboard_->retransmitted( seqno ) ) ) {
+      pipe += message.sequence_length();
+    }
+  }
+
+  SACKScoreboard::Scan holes = scoreboard_->scan( mss_ );
+  for ( const auto& [seqno, message] : outstanding_ ) {
+    const uint64_t end = seqno + message.sequence_length();
+    if ( seqno >= scoreboard_->highest_sacked() || !holes.is_lost( end ) ) {
+      break; // holes further up are even less likely lost
+    }
+    if ( holes.holds( seqno, end ) || scoreboard_->retransmitted( seqno ) ) {
+      continue;
+    }
+    if ( pipe + message.sequence_length() > window ) {
+      break;
+    }
+    retransmit( message, transmit );
+    ++stats_.selective_retransmissions;
+    pipe += message.sequence_length();
+  }
+}
+
+void TCPSender::set_pacing( uint64_t max_rate, bool follow_window )
+{
+  pacing_max_rate_ = max_rate;
+  pacing_follows_window_ = follow_window;
+}
+
+double TCPSender::pacing_rate() const
+{
+  double rate = static_cast<double>( pacing_max_rate_ ) / 1000;
+  if ( pacing_follows_window_ && rtt_estimator_ && rtt_estimator_->srtt_ms().has_value() ) {
+    const bool slow_start
+      = congestion_control_ && congestion_control_->window() < congestion_control_->slow_start_threshold();
+    const double gain = slow_start ? 2 : 1.25;
+    const double window_rate
+      = gain * static_cast<double>( send_window() ) / max( *rtt_estimator_->srtt_ms(), 1.0 );
+    rate = rate > 0 ? min( rate, window_rate ) : window_rate;
+  }
+  return rate;
+}
+
+uint64_t TCPSender::send_window() const
+{
+  uint64_t window = window_size_ == 0 ? 1 : window_size_;
+  if ( congestion_control_ ) {
+    window = min( window, congestion_control_->window() );
+  }
+  return window;
+}
+
+bool TCPSender::hold_small_segment( uint64_t max_payload_size )
+{
+  // a full segment, the last of the stream, or nothing at all is never held
+  const uint64_t buffered = reader().bytes_buffered();
+  if ( coalescing_ == TCPConfig::Coalescing::NoDelay || buffered == 0 || writer().is_closed()
+       || min( buffered, max_payload_size ) >= mss_ ) {
+    return false;
+  }
+  if ( coalescing_ == TCPConfig::Coalescing::Nagle ? sequence_numbers_in_flight() == 0 : cork_expired() ) {
+    return false;
+  }
+  if ( !held_since_ms_.has_value() ) {
+    held_since_ms_ = now_ms_;
+  }
+  return true;
+}
+
+bool TCPSender::cork_expired() const
+{
+  return coalescing_ == TCPConfig::Coalescing::Cork && held_since_ms_.has_value()
+         && now_ms_ - *held_since_ms_ >= CORK_TIMEOUT_MS;
+}
+
+void TCPSender::set_mtu_probing( size_t max_mss )
+{
+  probe_max_ = max_mss;
+  probe_ceiling_ = max_mss + 1;
+}
+
+size_t TCPSender::next_probe_size() const
+{
+  if ( probe_seqno_.has_value() || probe_max_ <= mss_ ) {
+    return 0;
+  }
+  if ( probe_ceiling_ > probe_max_ ) {
+    return probe_max_;
+  }
+  if ( probe_ceiling_ - mss_ <= PROBE_GRANULARITY ) {
+    return 0;
+  }
+  return ( mss_ + probe_ceiling_ ) / 2;
+}
+
+void TCPSender::resend_lost_probe( const TransmitFunction& transmit )
+{
+  auto probe = outstanding_.extract( outstanding_.begin() );
+  const uint64_t seqno = probe.key();
+  TCPSenderMessage& message = probe.mapped();
+  probe_ceiling_ = message.payload.size();
+  probe_seqno_.reset();
+
+  // a probe never carries a SYN, so its payload starts at its seqno
+  for ( size_t offset = 0; offset < message.payload.size(); offset += mss_ ) {
+    TCPSenderMessage piece { message.seqno + static_cast<uint32_t>( offset ),
+                             false,
+                             message.payload.substr( offset, mss_ ),
+                             message.FIN && offset + mss_ >= message.payload.size(),
+                             message.RST };
+    retransmit( piece, transmit );
+    outstanding_.emplace( seqno + offset, move( piece ) );
+  }
+}
+
+string TCPSender::Stats::to_string() const
+{
+  ostringstream out;
+  out << duplicate_acks << " duplicate ACKs, " << fast_retransmissions << " fast retransmissions, "
+      << timeout_retransmissions << " timeout retransmissions, " << selective_retransmissions
+      << " selective retransmissions";
+  return out.str();
 }
@@ -1,15 +1,21 @@
 #pragma once
 
 #include "byte_stream.hh"
+#include "congestion_control.hh"
+#include "rtt_estimator.hh"
+#include "sack_scoreboard.hh"
+#include "token_bucket.hh"
+#include "tcp_config.hh"
 #include "tcp_receiver_message.hh"
 #include "tcp_sender_message.hh"
 
 #include <cstdint>
 #include <functional>
 #include <list>
+#include <map>
 #include <memory>
 #include <optional>
-#include <queue>
+#include <string>
 
 class TCPSender
 {
@@ -37,12 +43,94 @@ public:
   /* Time has passed by the given # of milliseconds since the last time the tick() method was called */
   void tick( uint64_t ms_since_last_tick, const TransmitFunction& transmit );
 
+  /* Apply the sender options of `config` through the setters below (the constructor takes the rest) */
+  void configure( const TCPConfig& config );
+
+  /* Send at most `mss` bytes of payload per segment */
+  void set_mss( size_t mss ) { mss_ = mss; }
+
+  /*
+   * Packetization-layer path MTU discovery (RFC 4821). Now and then, when enough data is waiting, send one
+   * segment larger than the MSS (up to `max_mss` bytes of payload) as a probe. An acknowledged probe raises
+   * the MSS to its size. A probe that times out is taken to be too large for the path: later probes stay
+   * below it, and its data is resent at once in MSS-sized segments, without backing off the timer.
+   * The first probe tries `max_mss` itself; after a loss, the search halves the remaining range.
+   * Zero (the default) turns probing off.
+   */
+  void set_mtu_probing( size_t max_mss );
+
+  /*
+   * Keep no more in flight than the congestion window of `congestion_control`, which also decides when
+   * duplicate ACKs call for a fast retransmission. nullptr (the default) sends whatever the receiver's window
+   * allows, and leaves lost segments to the retransmission timer.
+   */
+  void set_congestion_control( std::unique_ptr<CongestionControl> congestion_control );
+
+  /*
+   * Resend the oldest outstanding segment on the third duplicate ACK in a row, without waiting for the timer
+   * (RFC 5681 fast retransmit). Off by default. With a congestion controller, the controller decides instead.
+   */
+  void set_fast_retransmit( bool enabled ) { fast_retransmit_ = enabled; }
+
+  /*
+   * Keep a scoreboard of the ranges the peer's SACK blocks say it holds, and resend every hole it shows to be
+   * lost (RFC 6675), as far as the window allows, instead of only the oldest segment. A timeout clears the
+   * scoreboard, since the peer may have discarded data it SACKed; only later SACK blocks count. Off by
+   * default.
+   */
+  void set_selective_retransmit( bool enabled );
+
+  /*
+   * Pace new segments with a token bucket that tick() refills (and then sends from), instead of sending all
+   * the window allows at once. The rate is at most `max_rate` bytes per second (zero for no fixed limit) and,
+   * if `follow_window`, the window spread over the smoothed RTT, with some headroom: twice that in slow
+   * start, 1.25 times after. Following the window needs RTT estimation, and takes effect from the first
+   * sample. Off by default.
+   */
+  void set_pacing( uint64_t max_rate, bool follow_window );
+
+  /*
+   * Choose what push() does with less than a full segment of data: send it at once (NoDelay, the default),
+   * hold it while anything sent is unacknowledged (Nagle), or hold it until a full segment builds up (Cork).
+   * Corked data goes out anyway once it has waited CORK_TIMEOUT_MS, at the next tick(). Closing the stream
+   * sends whatever is held.
+   */
+  void set_coalescing( TCPConfig::Coalescing mode ) { coalescing_ = mode; }
+  static constexpr uint64_t CORK_TIMEOUT_MS = 200;
+
+  /*
+   * Adapt the retransmission timeout to the measured round-trip time (RFC 6298), keeping it within
+   * [min_RTO_ms, max_RTO_ms]. One segment at a time is timed, and a resent segment is never used as a sample
+   * (Karn's algorithm); a backed-off RTO stays in force until the next sample. Without selective
+   * retransmission, any retransmission abandons the measurement, since the timed segment's ACK may wait for
+   * the hole; with it, the timed segment is sampled as soon as it is SACKed.
+   * Zero `min_RTO_ms` (the default) keeps the initial RTO, doubled on each timeout.
+   */
+  void set_rtt_estimation( uint64_t min_RTO_ms, uint64_t max_RTO_ms );
+
   // Accessors
+  size_t mss() const { return mss_; }           // Most payload bytes per segment (raised by MTU probing)
   uint64_t sequence_numbers_in_flight() const;  // How many sequence numbers are outstanding?
   uint64_t consecutive_retransmissions() const; // How many consecutive *re*transmissions have happened?
   Writer& writer() { return input_.writer(); }
   const Writer& writer() const { return input_.writer(); }
 
+  const CongestionControl* congestion_control() const { return congestion_control_.get(); }
+  const std::optional<RTTEstimator>& rtt_estimator() const { return rtt_estimator_; }
+  const std::optional<SACKScoreboard>& scoreboard() const { return scoreboard_; }
+  uint64_t current_RTO_ms() const { return current_RTO_ms_; }
+
+  struct Stats
+  {
+    uint64_t duplicate_acks {};            // ACKs of nothing new, with data outstanding and an unchanged window
+    uint64_t fast_retransmissions {};      // segments resent because of duplicate (or partial) ACKs
+    uint64_t timeout_retransmissions {};   // segments resent because the timer expired (lost MTU probes aside)
+    uint64_t selective_retransmissions {}; // holes resent because SACK blocks showed them lost
+
+    std::string to_string() const;
+  };
+  const Stats& stats() const { return stats_; }
+
   // Access input stream reader, but const-only (can't read from outside)
   const Reader& reader() const { return input_.reader(); }
 
@@ -55,6 +143,7 @@ private:
   uint64_t timer_ { 0 };
   bool is_timer_on { false };
   uint64_t retx_attempts_ { 0 };
+  uint64_t now_ms_ { 0 }; // time since construction, as told by tick()
 
   bool is_syn_ { false };
   bool is_fin_ { false };
@@ -64,5 +153,44 @@ private:
   uint64_t send_cnt_ { 0 };
   uint64_t ack_cnt_ { 0 };
 
-  std::queue<TCPSenderMessage> send_queue_; // Queue of send messages; it has Wrap32 seqno;
+  std::map<uint64_t, TCPSenderMessage> outstanding_ {}; // Sent but unacknowledged, by absolute seqno
+
+  std::unique_ptr<CongestionControl> congestion_control_ {};
+  bool retransmit_due_ { false }; // resend the first outstanding segment at the next push()
+  bool fast_retransmit_ { false };
+  unsigned duplicate_acks_ { 0 }; // in a row, since the ackno last moved
+  Stats stats_ {};
+
+  // RTT estimation
+  std::optional<RTTEstimator> rtt_estimator_ {};
+  std::optional<uint64_t> timed_seqno_ {}; // absolute seqno of the segment being timed
+  uint64_t timed_since_ms_ { 0 };         // ... and when it was sent
+  void retransmit( const TCPSenderMessage& message, const TransmitFunction& transmit ); // and stop timing it
+
+  std::optional<SACKScoreboard> scoreboard_ {};
+  void resend_lost_holes( uint64_t window, const TransmitFunction& transmit );
+
+  // Pacing
+  uint64_t pacing_max_rate_ { 0 }; // bytes per second
+  bool pacing_follows_window_ { false };
+  TokenBucket pacing_bucket_ {};
+  double pacing_rate() const; // bytes per millisecond, or zero if not pacing
+
+  uint64_t send_window() const; // the receiver's window, limited by the congestion window
+
+  // Small writes
+  TCPConfig::Coalescing coalescing_ { TCPConfig::Coalescing::NoDelay };
+  std::optional<uint64_t> held_since_ms_ {}; // when push() first held back the data still buffered
+  bool hold_small_segment( uint64_t max_payload_size );
+  bool cork_expired() const;
+
+  size_t mss_ { TCPConfig::MAX_PAYLOAD_SIZE };
+
+  // Path MTU discovery
+  static constexpr size_t PROBE_GRANULARITY = 32; // stop searching once the range is this narrow
+  size_t probe_max_ { 0 };                        // largest payload to try; at most mss_ when not probing
+  size_t probe_ceiling_ { 0 };                    // smallest payload known to be lost on the path
+  std::optional<uint64_t> probe_seqno_ {};        // absolute seqno of the probe in flight
+  size_t next_probe_size() const;                 // zero if no probe is due
+  void resend_lost_probe( const TransmitFunction& transmit );
 };
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+/*
+ * A token bucket for pacing: tokens (bytes) accrue at the current rate as time passes, and each segment sent
+ * takes its length. The bucket holds at most one refill's worth, or `min_depth` if that is more, so a sender
+ * that fell idle cannot save up a burst. Sending may overdraw the bucket; then the next segment waits until
+ * the debt is paid back.
+ */
+class TokenBucket
+{
+public:
+  void refill( double bytes_per_ms, uint64_t ms, uint64_t min_depth )
+  {
+    const double added = bytes_per_ms * static_cast<double>( ms );
+    tokens_ = std::min( tokens_ + added, std::max( added, static_cast<double>( min_depth ) ) );
+  }
+
+  bool ready() const { return tokens_ >= 0; }
+  void take( uint64_t bytes ) { tokens_ -= static_cast<double>( bytes ); }
+
+private:
+  double tokens_ {};
+};
@@ -0,0 +1,121 @@
+#include "buffer_pool.hh"
+#include "byte_stream.hh"
+#include "test_should_be.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <utility>
+
+using namespace std;
+
+void size_classes()
+{
+  BufferPool pool;
+
+  // a fresh take() allocates a whole block of the smallest class that fits
+  string small = pool.take( 100 );
+  test_should_be( small.size(), size_t { 0 } );
+  test_should_be( small.capacity() >= BufferPool::MIN_BLOCK_SIZE, true );
+  string medium = pool.take( 5000 );
+  test_should_be( medium.capacity() >= size_t { 8192 }, true );
+
+  // buffers come back cleared, and a later take() of the same class reuses them
+  medium.append( "payload" );
+  const char* medium_data = medium.data();
+  pool.give( move( medium ) );
+  string reused = pool.take( 8000 );
+  test_should_be( reused.data() == medium_data, true );
+  test_should_be( reused.size(), size_t { 0 } );
+
+  // a buffer can't serve a class larger than its capacity
+  pool.give( move( small ) );
+  test_should_be( pool.stats().at( 0 ).cached, uint64_t { 1 } );
+  test_should_be( pool.stats().at( 1 ).cached, uint64_t { 0 } );
+
+  // tiny and oversized buffers are not cached
+  pool.give( string( 10, 'x' ) );
+  string huge = pool.take( 4 * BufferPool::MAX_BLOCK_SIZE );
+  test_should_be( huge.capacity() >= 4 * BufferPool::MAX_BLOCK_SIZE, true );
+  pool.give( move( huge ) );
+
+  uint64_t cached = 0;
+  for ( const auto& s : pool.stats() ) {
+    cached += s.cached;
+  }
+  test_should_be( cached, uint64_t { 1 } );
+
+  const auto stats = pool.stats().at( 2 );
+  test_should_be( stats.block_size, size_t { 8192 } );
+  test_should_be( stats.takes, uint64_t { 2 } );
+  test_should_be( stats.reuses, uint64_t { 1 } );
+  test_should_be( stats.gives, uint64_t { 1 } );
+
+  pool.clear();
+  test_should_be( pool.stats().at( 0 ).cached, uint64_t { 0 } );
+}
+
+void cache_limit()
+{
+  BufferPool pool;
+  for ( size_t i = 0; i < BufferPool::MAX_CACHED_PER_CLASS + 10; ++i ) {
+    pool.give( string( BufferPool::MIN_BLOCK_SIZE, 'x' ) );
+  }
+  test_should_be( pool.stats().at( 0 ).gives, uint64_t { BufferPool::MAX_CACHED_PER_CLASS + 10 } );
+  test_should_be( pool.stats().at( 0 ).cached, uint64_t { BufferPool::MAX_CACHED_PER_CLASS } );
+}
+
+void streams_share_buffers( ByteStream::Storage storage )
+{
+  BufferPool& pool = BufferPool::global();
+  pool.clear();
+
+  auto total_reuses = [&] {
+    uint64_t reuses = 0;
+    for ( const auto& s : pool.stats() ) {
+      reuses += s.reuses;
+    }
+    return reuses;
+  };
+
+  const string chunk( 16384, 'a' );
+  {
+    ByteStream bs { 65536, storage };
+    bs.writer().push( chunk );
+    bs.writer().push( chunk );
+  } // the destroyed stream's storage goes back to the pool
+
+  const uint64_t reuses_before = total_reuses();
+  {
+    ByteStream bs { 65536, storage };
+    bs.writer().push( chunk );
+    bs.reader().pop( chunk.size() );
+  }
+  if ( storage == ByteStream::Storage::Ring ) {
+    // the second stream's ring came from the pool instead of the heap
+    test_should_be( total_reuses() > reuses_before, true );
+  }
+
+  uint64_t cached = 0;
+  for ( const auto& s : pool.stats() ) {
+    cached += s.cached;
+  }
+  test_should_be( cached > 0, true );
+}
+
+int main()
+{
+  try {
+    size_classes();
+    cache_limit();
+    streams_share_buffers( ByteStream::Storage::Ring );
+    streams_share_buffers( ByteStream::Storage::Chunked );
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
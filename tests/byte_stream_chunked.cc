@@ -0,0 +1,73 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto chunked = ByteStream::Storage::Chunked;
+
+    {
+      ByteStreamTestHarness test { "peek sees front chunk", 15, chunked };
+      test.execute( Push { "cat" } );
+      test.execute( Push { "tac" } );
+      test.execute( PeekOnce { "cat" } );
+      test.execute( Peek { "cattac" } );
+      test.execute( BytesBuffered { 6 } );
+      test.execute( AvailableCapacity { 9 } );
+
+      test.execute( Pop { 2 } );
+      test.execute( PeekOnce { "t" } );
+      test.execute( Pop { 2 } );
+      test.execute( PeekOnce { "ac" } );
+      test.execute( BytesPopped { 4 } );
+      test.execute( AvailableCapacity { 13 } );
+    }
+
+    {
+      ByteStreamTestHarness test { "tail chunk trimmed to capacity", 8, chunked };
+      test.execute( Push { "hello" } );
+      test.execute( Push { "world" } );
+      test.execute( BytesPushed { 8 } );
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( Push { "dropped" } );
+      test.execute( BytesPushed { 8 } );
+      test.execute( Peek { "hellowor" } );
+
+      test.execute( Pop { 8 } );
+      test.execute( AvailableCapacity { 8 } );
+      test.execute( Push { "again" } );
+      test.execute( PeekOnce { "again" } );
+    }
+
+    {
+      ByteStreamTestHarness test { "pop spanning chunks", 15, chunked };
+      test.execute( Push { "a" } );
+      test.execute( Push { "bc" } );
+      test.execute( Push { "def" } );
+      test.execute( Close {} );
+      test.execute( Pop { 4 } );
+      test.execute( PeekOnce { "ef" } );
+      test.execute( IsFinished { false } );
+      test.execute( Pop { 2 } );
+      test.execute( BufferEmpty { true } );
+      test.execute( IsFinished { true } );
+    }
+
+    {
+      ByteStreamTestHarness test { "zero capacity", 0, chunked };
+      test.execute( Push { "x" } );
+      test.execute( BytesPushed { 0 } );
+      test.execute( Peek { "" } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,103 @@
+#include "concurrent_byte_stream.hh"
+#include "test_should_be.hh"
+
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <poll.h>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+void transfer( const size_t input_len,   // NOLINT(bugprone-easily-swappable-parameters)
+               const size_t capacity,    // NOLINT(bugprone-easily-swappable-parameters)
+               const size_t random_seed, // NOLINT(bugprone-easily-swappable-parameters)
+               const bool sleep_on_eventfd )
+{
+  const string data = [&] {
+    default_random_engine rd { random_seed };
+    uniform_int_distribution<char> ud;
+    string ret;
+    for ( size_t i = 0; i < input_len; ++i ) {
+      ret += ud( rd );
+    }
+    return ret;
+  }();
+
+  ConcurrentByteStream bs { capacity };
+
+  thread writer_thread { [&] {
+    default_random_engine rd { random_seed + 1 };
+    uniform_int_distribution<size_t> write_size { 1, capacity };
+    size_t pushed = 0;
+    while ( pushed < data.size() ) {
+      const auto before = bs.writer().bytes_pushed();
+      bs.writer().push( data.substr( pushed, write_size( rd ) ) );
+      pushed += bs.writer().bytes_pushed() - before;
+      if ( bs.writer().bytes_pushed() == before ) {
+        this_thread::yield(); // stream is full; let the reader run
+      }
+    }
+    bs.writer().close();
+  } };
+
+  string output;
+  while ( not bs.reader().is_finished() ) {
+    if ( sleep_on_eventfd ) {
+      pollfd pfd { bs.wakeup_fd().fd_num(), POLLIN, 0 };
+      ::poll( &pfd, 1, 1000 );
+      bs.reader().consume_wakeup();
+    } else if ( bs.reader().bytes_buffered() == 0 ) {
+      this_thread::yield();
+    }
+    while ( bs.reader().bytes_buffered() ) {
+      const auto peeked = bs.reader().peek();
+      if ( peeked.empty() ) {
+        throw runtime_error( "ConcurrentReader::peek() returned empty view" );
+      }
+      output += peeked;
+      bs.reader().pop( peeked.size() );
+    }
+  }
+
+  writer_thread.join();
+
+  test_should_be( bs.reader().bytes_popped(), static_cast<uint64_t>( input_len ) );
+  if ( output != data ) {
+    throw runtime_error( "Mismatch between data written and read" );
+  }
+}
+
+int main()
+{
+  try {
+    {
+      ConcurrentByteStream bs { 4 };
+      bs.writer().push( "abcdef" );
+      test_should_be( bs.writer().bytes_pushed(), uint64_t { 4 } );
+      test_should_be( bs.writer().available_capacity(), uint64_t { 0 } );
+      test_should_be( bs.reader().peek() == "abcd", true );
+      bs.reader().pop( 3 );
+      bs.writer().push( "ef" );
+      test_should_be( bs.reader().peek() == "d", true );
+      bs.reader().pop( 1 );
+      test_should_be( bs.reader().peek() == "ef", true );
+      bs.writer().close();
+      test_should_be( bs.reader().is_finished(), false );
+      bs.reader().pop( 2 );
+      test_should_be( bs.reader().is_finished(), true );
+    }
+
+    transfer( 1 << 20, 4096, 1234, false );
+    transfer( 1 << 18, 17, 5678, false );
+    transfer( 1 << 20, 65536, 9012, true );
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
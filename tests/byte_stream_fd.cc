@@ -0,0 +1,108 @@
+#include "buffer_pool.hh"
+#include "byte_stream.hh"
+#include "exception.hh"
+#include "file_descriptor.hh"
+#include "test_should_be.hh"
+
+#include <array>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <utility>
+
+using namespace std;
+
+pair<FileDescriptor, FileDescriptor> make_pipe()
+{
+  array<int, 2> fds {};
+  CheckSystemCall( "pipe", ::pipe( fds.data() ) );
+  return { FileDescriptor { fds[0] }, FileDescriptor { fds[1] } };
+}
+
+string read_all( Reader& reader )
+{
+  string out;
+  read( reader, reader.bytes_buffered(), out );
+  return out;
+}
+
+void check_string( const string& actual, const string& expected )
+{
+  if ( actual != expected ) {
+    throw runtime_error( "expected \"" + expected + "\", but found \"" + actual + "\"" );
+  }
+}
+
+void fill_and_drain( ByteStream::Storage storage )
+{
+  auto [read_end, write_end] = make_pipe();
+  ByteStream bs { 8, storage };
+
+  // fill from the pipe, limited by the available capacity
+  write_end.write( "abcdefghij" );
+  test_should_be( bs.writer().fill_from( read_end ), uint64_t { 8 } );
+  test_should_be( bs.writer().bytes_pushed(), uint64_t { 8 } );
+  test_should_be( bs.writer().available_capacity(), uint64_t { 0 } );
+  test_should_be( bs.writer().fill_from( read_end ), uint64_t { 0 } );
+
+  // free some space so the next fill wraps around the end of the ring
+  string out;
+  read( bs.reader(), 5, out );
+  check_string( out, "abcde" );
+  test_should_be( bs.writer().fill_from( read_end ), uint64_t { 2 } );
+  check_string( read_all( bs.reader() ), "fghij" );
+
+  // drain to the pipe and read back what was written
+  bs.writer().push( "klmnop" );
+  read( bs.reader(), 1, out );
+  test_should_be( bs.reader().drain_to( write_end ), uint64_t { 5 } );
+  test_should_be( bs.reader().bytes_buffered(), uint64_t { 0 } );
+  test_should_be( bs.reader().drain_to( write_end ), uint64_t { 0 } );
+  string piped;
+  read_end.read( piped );
+  check_string( piped, "lmnop" );
+
+  // EOF on the source is visible through the descriptor
+  write_end.close();
+  test_should_be( bs.writer().fill_from( read_end ), uint64_t { 0 } );
+  test_should_be( read_end.eof(), true );
+}
+
+// In chunked mode, a short read into a large stream neither allocates the whole capacity nor keeps the buffer
+void short_chunked_read()
+{
+  auto [read_end, write_end] = make_pipe();
+  ByteStream bs { 1 << 20, ByteStream::Storage::Chunked };
+
+  const auto read_buffer_gives = [] {
+    for ( const auto& size_class : BufferPool::global().stats() ) {
+      if ( size_class.block_size == FileDescriptor::kReadBufferSize ) {
+        return size_class.gives;
+      }
+    }
+    throw runtime_error( "no buffer pool class holds read buffers" );
+  };
+
+  const uint64_t gives_before = read_buffer_gives();
+  write_end.write( string( 100, 'x' ) );
+  test_should_be( bs.writer().fill_from( read_end ), uint64_t { 100 } );
+  test_should_be( read_buffer_gives(), gives_before + 1 );
+  check_string( read_all( bs.reader() ), string( 100, 'x' ) );
+}
+
+int main()
+{
+  try {
+    fill_and_drain( ByteStream::Storage::Ring );
+    fill_and_drain( ByteStream::Storage::Chunked );
+    short_chunked_read();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,223 @@
+#include "byte_stream.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+// Sweeps ByteStream throughput over storage mode, capacity, write size and read size, and prints one CSV row
+// per configuration. Given `--baseline FILE` (a CSV written by an earlier run), it fails if any configuration
+// falls below (1 - tolerance) times its baseline throughput. The baseline may come from another machine, so
+// the default tolerance of 0.75 only catches a configuration slowing to a quarter of its baseline or worse.
+//
+// Regenerate the baseline with: byte_stream_matrix_speed_test > tests/byte_stream_matrix_baseline.csv
+
+namespace {
+
+using Config = tuple<string, size_t, size_t, size_t>; // storage, capacity, write_size, read_size
+
+struct Result
+{
+  size_t bytes {};
+  double gbit_per_s {};
+  double ns_per_op {};
+};
+
+constexpr unsigned TRIALS = 3; // report the best of this many runs, to reduce scheduling noise
+
+string storage_name( ByteStream::Storage storage )
+{
+  return storage == ByteStream::Storage::Ring ? "ring" : "chunked";
+}
+
+Result run_once( const string& data,
+                 ByteStream::Storage storage,
+                 size_t capacity,   // NOLINT(bugprone-easily-swappable-parameters)
+                 size_t write_size, // NOLINT(bugprone-easily-swappable-parameters)
+                 size_t read_size ) // NOLINT(bugprone-easily-swappable-parameters)
+{
+  vector<string> split_data;
+  for ( size_t i = 0; i < data.size(); i += write_size ) {
+    split_data.emplace_back( data.substr( i, write_size ) );
+  }
+
+  ByteStream bs { capacity, storage };
+  string output_data;
+  output_data.reserve( data.size() );
+  size_t next_write = 0;
+  uint64_t ops = 0;
+
+  const auto start_time = steady_clock::now();
+  while ( not bs.reader().is_finished() ) {
+    if ( next_write == split_data.size() ) {
+      if ( not bs.writer().is_closed() ) {
+        bs.writer().close();
+      }
+    } else if ( split_data[next_write].size() <= bs.writer().available_capacity() ) {
+      bs.writer().push( move( split_data[next_write] ) );
+      ++next_write;
+      ++ops;
+    }
+
+    if ( bs.reader().bytes_buffered() ) {
+      auto peeked = bs.reader().peek().substr( 0, read_size );
+      if ( peeked.empty() ) {
+        throw runtime_error( "ByteStream::reader().peek() returned empty view" );
+      }
+      output_data += peeked;
+      bs.reader().pop( peeked.size() );
+      ++ops;
+    }
+  }
+  const auto stop_time = steady_clock::now();
+
+  if ( data != output_data ) {
+    throw runtime_error( "Mismatch between data written and read" );
+  }
+
+  const double seconds = duration_cast<duration<double>>( stop_time - start_time ).count();
+  return { data.size(),
+           8 * static_cast<double>( data.size() ) / seconds / 1e9,
+           seconds * 1e9 / static_cast<double>( ops ) };
+}
+
+map<Config, Result> run_matrix()
+{
+  const string data = [] {
+    default_random_engine rd { 789 };
+    uniform_int_distribution<char> ud;
+    string ret;
+    for ( size_t i = 0; i < 8'000'000; ++i ) {
+      ret += ud( rd );
+    }
+    return ret;
+  }();
+
+  map<Config, Result> results;
+  for ( const auto storage : { ByteStream::Storage::Ring, ByteStream::Storage::Chunked } ) {
+    for ( const size_t capacity : { 4096UL, 65536UL, 1048576UL } ) {
+      for ( const size_t write_size : { 1UL, 1500UL, 65536UL } ) {
+        for ( const size_t read_size : { 1UL, 128UL, 65536UL } ) {
+          if ( write_size > capacity ) {
+            continue;
+          }
+          // single-byte operations are slow enough that a smaller input gives a stable measurement
+          const size_t input_len = ( write_size == 1 or read_size == 1 ) ? 1'000'000 : data.size();
+          const string input = data.substr( 0, input_len );
+
+          Result best;
+          for ( unsigned trial = 0; trial < TRIALS; ++trial ) {
+            const Result r = run_once( input, storage, capacity, write_size, read_size );
+            if ( r.gbit_per_s > best.gbit_per_s ) {
+              best = r;
+            }
+          }
+          results[{ storage_name( storage ), capacity, write_size, read_size }] = best;
+        }
+      }
+    }
+  }
+  return results;
+}
+
+map<Config, double> read_baseline( const string& filename )
+{
+  ifstream file { filename };
+  if ( not file ) {
+    throw runtime_error( "could not open baseline " + filename );
+  }
+
+  map<Config, double> baseline;
+  string line;
+  getline( file, line ); // header
+  while ( getline( file, line ) ) {
+    if ( line.empty() ) {
+      continue;
+    }
+    replace( line.begin(), line.end(), ',', ' ' );
+    istringstream fields { line };
+    string storage;
+    size_t capacity {}, write_size {}, read_size {}, bytes {};
+    double gbit_per_s {};
+    if ( not( fields >> storage >> capacity >> write_size >> read_size >> bytes >> gbit_per_s ) ) {
+      throw runtime_error( "malformed baseline line: " + line );
+    }
+    baseline[{ storage, capacity, write_size, read_size }] = gbit_per_s;
+  }
+  return baseline;
+}
+
+void program_body( const vector<string>& args )
+{
+  string baseline_file;
+  double tolerance = 0.75;
+  for ( size_t i = 0; i < args.size(); ++i ) {
+    if ( args[i] == "--baseline" and i + 1 < args.size() ) {
+      baseline_file = args[++i];
+    } else if ( args[i] == "--tolerance" and i + 1 < args.size() ) {
+      tolerance = stod( args[++i] );
+    } else {
+      throw runtime_error( "usage: byte_stream_matrix_speed_test [--baseline FILE] [--tolerance FRACTION]" );
+    }
+  }
+
+  const auto results = run_matrix();
+
+  cout << "storage,capacity,write_size,read_size,bytes,gbit_per_s,ns_per_op\n";
+  for ( const auto& [config, r] : results ) {
+    const auto& [storage, capacity, write_size, read_size] = config;
+    cout << storage << "," << capacity << "," << write_size << "," << read_size << "," << r.bytes << "," << fixed
+         << setprecision( 3 ) << r.gbit_per_s << "," << setprecision( 2 ) << r.ns_per_op << "\n";
+  }
+
+  if ( baseline_file.empty() ) {
+    return;
+  }
+
+  unsigned regressions = 0;
+  for ( const auto& [config, expected] : read_baseline( baseline_file ) ) {
+    const auto& [storage, capacity, write_size, read_size] = config;
+    const auto it = results.find( config );
+    if ( it == results.end() ) {
+      continue; // configuration no longer measured
+    }
+    if ( it->second.gbit_per_s < expected * ( 1 - tolerance ) ) {
+      cerr << "Regression: storage=" << storage << ", capacity=" << capacity << ", write_size=" << write_size
+           << ", read_size=" << read_size << " reached " << fixed << setprecision( 3 ) << it->second.gbit_per_s
+           << " Gbit/s, baseline " << expected << " Gbit/s.\n";
+      ++regressions;
+    }
+  }
+
+  if ( regressions ) {
+    throw runtime_error( to_string( regressions ) + " ByteStream configuration(s) regressed by more than "
+                         + to_string( static_cast<int>( tolerance * 100 ) ) + "% from the baseline." );
+  }
+}
+
+} // namespace
+
+int main( int argc, char* argv[] )
+{
+  try {
+    program_body( { argv + 1, argv + argc } );
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
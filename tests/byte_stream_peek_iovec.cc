@@ -0,0 +1,50 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      ByteStreamTestHarness test { "empty stream", 4 };
+      test.execute( PeekIovec { {} } );
+    }
+
+    {
+      ByteStreamTestHarness test { "contiguous ring", 8 };
+      test.execute( Push { "abcd" } );
+      test.execute( PeekIovec { { "abcd" } } );
+    }
+
+    {
+      ByteStreamTestHarness test { "ring wraps around", 8 };
+      test.execute( Push { "abcdef" } );
+      test.execute( Pop { 4 } );
+      test.execute( Push { "ghijk" } );
+      test.execute( PeekOnce { "efgh" } );
+      test.execute( PeekIovec { { "efgh", "ijk" } } );
+      test.execute( Pop { 4 } );
+      test.execute( PeekIovec { { "ijk" } } );
+    }
+
+    {
+      ByteStreamTestHarness test { "every chunk", 15, ByteStream::Storage::Chunked };
+      test.execute( Push { "cat" } );
+      test.execute( Push { "tac" } );
+      test.execute( Push { "dog" } );
+      test.execute( Pop { 1 } );
+      test.execute( PeekIovec { { "at", "tac", "dog" } } );
+      test.execute( Pop { 4 } );
+      test.execute( PeekIovec { { "c", "dog" } } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,122 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+#include <random>
+
+using namespace std;
+
+struct SetCapacity : public Action<ByteStream>
+{
+  uint64_t capacity_;
+
+  explicit SetCapacity( uint64_t capacity ) : capacity_( capacity ) {}
+  std::string description() const override { return "set_capacity( " + std::to_string( capacity_ ) + " )"; }
+  void execute( ByteStream& bs ) const override { bs.set_capacity( capacity_ ); }
+};
+
+struct ReadPrefix : public Expectation<ByteStream>
+{
+  std::string output_;
+
+  explicit ReadPrefix( std::string output ) : output_( move( output ) ) {}
+  std::string description() const override { return "reading \"" + Printer::prettify( output_ ) + "\""; }
+  void execute( ByteStream& bs ) const override
+  {
+    std::string got;
+    read( bs.reader(), output_.size(), got );
+    if ( got != output_ ) {
+      throw ExpectationViolation { "Expected to read \"" + Printer::prettify( output_ ) + "\", but found \""
+                                   + Printer::prettify( got ) + "\"" };
+    }
+  }
+};
+
+void random_resizes( const size_t input_len, const size_t random_seed ) // NOLINT(*-swappable-parameters)
+{
+  default_random_engine rd { random_seed };
+  const string data = [&] {
+    uniform_int_distribution<char> ud;
+    string ret;
+    for ( size_t i = 0; i < input_len; ++i ) {
+      ret += ud( rd );
+    }
+    return ret;
+  }();
+
+  ByteStreamTestHarness test { "random resizes", 16 };
+  size_t pushed = 0;
+  size_t popped = 0;
+  uint64_t capacity = 16;
+  while ( popped < data.size() ) {
+    const uint64_t new_capacity = uniform_int_distribution<uint64_t> { 1, 20000 }( rd );
+    test.execute( SetCapacity { new_capacity } );
+    capacity = max( new_capacity, static_cast<uint64_t>( pushed - popped ) );
+
+    const size_t to_push = min( data.size() - pushed, uniform_int_distribution<size_t> { 0, 9000 }( rd ) );
+    test.execute( Push { data.substr( pushed, to_push ) } );
+    pushed += min( static_cast<uint64_t>( to_push ), capacity - ( pushed - popped ) );
+    test.execute( BytesBuffered { pushed - popped } );
+    test.execute( AvailableCapacity { capacity - ( pushed - popped ) } );
+
+    const size_t to_pop = uniform_int_distribution<size_t> { 0, pushed - popped }( rd );
+    test.execute( ReadPrefix { data.substr( popped, to_pop ) } );
+    popped += to_pop;
+  }
+}
+
+int main()
+{
+  try {
+    {
+      ByteStreamTestHarness test { "grow", 4 };
+      test.execute( Push { "abcd" } );
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( SetCapacity { 8 } );
+      test.execute( AvailableCapacity { 4 } );
+      test.execute( Push { "efghij" } );
+      test.execute( BytesPushed { 8 } );
+      test.execute( Peek { "abcdefgh" } );
+    }
+
+    {
+      ByteStreamTestHarness test { "grow while wrapped", 8 };
+      test.execute( Push { "abcdef" } );
+      test.execute( Pop { 5 } );
+      test.execute( Push { "ghijkl" } );
+      test.execute( SetCapacity { 16 } );
+      test.execute( Push { "mnop" } );
+      test.execute( Peek { "fghijklmnop" } );
+    }
+
+    {
+      ByteStreamTestHarness test { "shrink keeps buffered bytes", 15 };
+      test.execute( Push { "hello world" } );
+      test.execute( SetCapacity { 5 } );
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( Pop { 6 } );
+      test.execute( AvailableCapacity { 6 } );
+      test.execute( SetCapacity { 5 } );
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( Peek { "world" } );
+      test.execute( Pop { 5 } );
+      test.execute( AvailableCapacity { 5 } );
+    }
+
+    {
+      ByteStreamTestHarness test { "chunked", 4, ByteStream::Storage::Chunked };
+      test.execute( Push { "abcd" } );
+      test.execute( SetCapacity { 6 } );
+      test.execute( Push { "efgh" } );
+      test.execute( Peek { "abcdef" } );
+    }
+
+    random_resizes( 1'000'000, 2718 );
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -16,8 +16,13 @@ static_assert( sizeof( Writer ) == sizeof( ByteStream ),
 class ByteStreamTestHarness : public TestHarness<ByteStream>
 {
 public:
-  ByteStreamTestHarness( std::string test_name, uint64_t capacity )
-    : TestHarness( move( test_name ), "capacity=" + std::to_string( capacity ), ByteStream { capacity } )
+  ByteStreamTestHarness( std::string test_name,
+                         uint64_t capacity,
+                         ByteStream::Storage storage = ByteStream::Storage::Ring )
+    : TestHarness( move( test_name ),
+                   "capacity=" + std::to_string( capacity )
+                     + ( storage == ByteStream::Storage::Chunked ? ", chunked" : "" ),
+                   ByteStream { capacity, storage } )
   {}
 
   size_t peek_size() { return object().reader().peek().size(); }
@@ -107,6 +112,38 @@ struct PeekOnce : public Peek
   }
 };
 
+struct PeekIovec : public Expectation<ByteStream>
+{
+  std::vector<std::string> output_;
+
+  explicit PeekIovec( std::vector<std::string> output ) : output_( move( output ) ) {}
+
+  std::string description() const override
+  {
+    std::string ret = "peek_iovec() gives {";
+    for ( const auto& x : output_ ) {
+      ret += " \"" + Printer::prettify( x ) + "\"";
+    }
+    return ret + " }";
+  }
+
+  void execute( ByteStream& bs ) const override
+  {
+    const auto views = bs.reader().peek_iovec();
+    if ( views.size() != output_.size() ) {
+      throw ExpectationViolation { "Expected " + std::to_string( output_.size() ) + " views from peek_iovec(), "
+                                   + "but found " + std::to_string( views.size() ) };
+    }
+    for ( size_t i = 0; i < views.size(); ++i ) {
+      if ( views[i] != output_[i] ) {
+        throw ExpectationViolation { "Expected view " + std::to_string( i ) + " to be \""
+                                     + Printer::prettify( output_[i] ) + "\", but found \""
+                                     + Printer::prettify( views[i] ) + "\"" };
+      }
+    }
+  }
+};
+
 struct IsClosed : public ConstExpectBool<ByteStream>
 {
   using ConstExpectBool::ConstExpectBool;
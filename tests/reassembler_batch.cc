@@ -0,0 +1,118 @@
+#include "byte_stream.hh"
+#include "reassembler.hh"
+#include "test_should_be.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+string read_all( Reader& reader )
+{
+  string out;
+  read( reader, reader.bytes_buffered(), out );
+  return out;
+}
+
+void sorted_burst()
+{
+  // a burst that arrived backwards is pushed in order without storing anything
+  Reassembler ra { ByteStream { 100 } };
+  vector<Reassembler::Substring> burst { { 6, "ghi", true }, { 3, "def", false }, { 0, "abc", false } };
+  ra.insert_batch( burst );
+  test_should_be( ra.stats().fast_path_inserts, uint64_t { 3 } );
+  test_should_be( ra.stats().slow_path_inserts, uint64_t { 0 } );
+  test_should_be( ra.writer().is_closed(), true );
+  if ( read_all( ra.reader() ) != "abcdefghi" ) {
+    throw runtime_error( "sorted burst was not reassembled" );
+  }
+}
+
+void burst_with_gap()
+{
+  Reassembler ra { ByteStream { 8 } };
+  vector<Reassembler::Substring> burst { { 4, "efghij", false }, { 1, "bc", false }, { 20, "z", true } };
+  ra.insert_batch( burst );
+  test_should_be( ra.writer().bytes_pushed(), uint64_t { 0 } );
+  test_should_be( ra.bytes_pending(), uint64_t { 6 } ); // "bc" and "efgh"; "ij" and "z" are beyond capacity
+
+  vector<Reassembler::Substring> fill { { 3, "d", false }, { 0, "a", false } };
+  ra.insert_batch( fill );
+  test_should_be( ra.writer().bytes_pushed(), uint64_t { 8 } );
+  test_should_be( ra.bytes_pending(), uint64_t { 0 } );
+  test_should_be( ra.writer().is_closed(), false );
+  if ( read_all( ra.reader() ) != "abcdefgh" ) {
+    throw runtime_error( "burst with a gap was not reassembled" );
+  }
+}
+
+// Random bursts give the same output whether they are inserted one at a time or as a batch
+void compare_with_single( const size_t random_seed )
+{
+  default_random_engine rd { random_seed };
+  const string data = [&] {
+    uniform_int_distribution<char> ud;
+    string ret;
+    for ( size_t i = 0; i < 20000; ++i ) {
+      ret += ud( rd );
+    }
+    return ret;
+  }();
+
+  Reassembler single { ByteStream { 2000 } };
+  Reassembler batched { ByteStream { 2000 } };
+  string single_out;
+  string batched_out;
+
+  uniform_int_distribution<size_t> burst_dist { 1, 12 };
+  uniform_int_distribution<size_t> len_dist { 0, 400 };
+  while ( batched_out.size() < data.size() ) {
+    vector<Reassembler::Substring> burst;
+    const size_t next = batched.writer().bytes_pushed();
+    for ( size_t n = burst_dist( rd ); n > 0; --n ) {
+      const size_t first_index = next + uniform_int_distribution<size_t> { 0, 2500 }( rd );
+      const size_t start = first_index > 200 ? first_index - 200 : 0;
+      if ( start < data.size() ) {
+        const string segment = data.substr( start, len_dist( rd ) );
+        burst.push_back( { start, segment, start + segment.size() == data.size() } );
+      }
+    }
+
+    for ( const auto& [first_index, segment, is_last] : burst ) {
+      single.insert( first_index, segment, is_last );
+    }
+    batched.insert_batch( burst );
+
+    test_should_be( batched.writer().bytes_pushed(), single.writer().bytes_pushed() );
+    test_should_be( batched.bytes_pending(), single.bytes_pending() );
+    single_out += read_all( single.reader() );
+    batched_out += read_all( batched.reader() );
+  }
+
+  if ( batched_out != data || single_out != data ) {
+    throw runtime_error( "batched and single inserts produced different output" );
+  }
+  test_should_be( batched.writer().is_closed(), true );
+}
+
+int main()
+{
+  try {
+    sorted_burst();
+    burst_with_gap();
+    for ( size_t seed = 0; seed < 32; ++seed ) {
+      compare_with_single( seed );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,137 @@
+#include "reassembler_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+struct SetLimits : public Action<Reassembler>
+{
+  Reassembler::Limits limits_;
+
+  explicit SetLimits( Reassembler::Limits limits ) : limits_( limits ) {}
+  std::string description() const override
+  {
+    return "set_limits( max_fragments=" + std::to_string( limits_.max_fragments )
+           + ", max_overhead_ratio=" + std::to_string( limits_.max_overhead_ratio ) + " )";
+  }
+  void execute( Reassembler& r ) const override { r.set_limits( limits_ ); }
+};
+
+struct FragmentCount : public ConstExpectNumber<Reassembler, uint64_t>
+{
+  using ConstExpectNumber::ConstExpectNumber;
+  std::string name() const override { return "fragment_count"; }
+  uint64_t value( const Reassembler& r ) const override { return r.fragment_count(); }
+};
+
+struct DroppedBytes : public ConstExpectNumber<Reassembler, uint64_t>
+{
+  using ConstExpectNumber::ConstExpectNumber;
+  std::string name() const override { return "stats().dropped_bytes"; }
+  uint64_t value( const Reassembler& r ) const override { return r.stats().dropped_bytes; }
+};
+
+struct CoalescedFragments : public ConstExpectNumber<Reassembler, uint64_t>
+{
+  using ConstExpectNumber::ConstExpectNumber;
+  std::string name() const override { return "stats().coalesced_fragments"; }
+  uint64_t value( const Reassembler& r ) const override { return r.stats().coalesced_fragments; }
+};
+
+struct MemoryUsageAtMost : public Expectation<Reassembler>
+{
+  uint64_t max_;
+
+  explicit MemoryUsageAtMost( uint64_t max ) : max_( max ) {}
+  std::string description() const override { return "memory_usage <= " + std::to_string( max_ ); }
+  void execute( Reassembler& r ) const override
+  {
+    if ( r.memory_usage() > max_ ) {
+      throw ExpectationViolation( "memory_usage was " + std::to_string( r.memory_usage() ) );
+    }
+  }
+};
+
+struct WithinOverheadRatio : public Expectation<Reassembler>
+{
+  double ratio_;
+
+  explicit WithinOverheadRatio( double ratio ) : ratio_( ratio ) {}
+  std::string description() const override
+  {
+    return "memory_usage <= " + std::to_string( ratio_ ) + " * bytes_pending";
+  }
+  void execute( Reassembler& r ) const override
+  {
+    if ( static_cast<double>( r.memory_usage() ) > ratio_ * static_cast<double>( r.bytes_pending() ) ) {
+      throw ExpectationViolation( "memory_usage was " + std::to_string( r.memory_usage() ) + " for "
+                                  + std::to_string( r.bytes_pending() ) + " bytes pending" );
+    }
+    if ( r.stats().dropped_bytes == 0 ) {
+      throw ExpectationViolation( "no fragments were dropped" );
+    }
+  }
+};
+
+int main()
+{
+  try {
+    {
+      ReassemblerTestHarness test { "fragment count is tracked", 100 };
+
+      test.execute( Insert { "c", 2 } );
+      test.execute( Insert { "e", 4 } );
+      test.execute( Insert { "g", 6 } );
+      test.execute( FragmentCount { 3 } );
+      test.execute( Insert { "bcde", 1 } ); // covers two fragments
+      test.execute( FragmentCount { 2 } );
+      test.execute( BytesPending( 5 ) );
+      test.execute( Insert { "a", 0 } );
+      test.execute( Insert { "f", 5 } );
+      test.execute( FragmentCount { 0 } );
+      test.execute( MemoryUsageAtMost { 0 } );
+      test.execute( ReadAll( "abcdefg" ) );
+    }
+
+    {
+      ReassemblerTestHarness test { "highest fragments are dropped", 100 };
+
+      test.execute( SetLimits( { 2, 0 } ) );
+      test.execute( Insert { "b", 1 } );
+      test.execute( Insert { "z", 25 } );
+      test.execute( Insert { "xy", 23 } ); // touches "z", so the two are merged instead
+      test.execute( FragmentCount { 2 } );
+      test.execute( CoalescedFragments { 1 } );
+      test.execute( DroppedBytes { 0 } );
+
+      test.execute( Insert { "d", 3 } ); // a third fragment: "xyz" is furthest away and goes
+      test.execute( FragmentCount { 2 } );
+      test.execute( BytesPending( 2 ) );
+      test.execute( DroppedBytes { 3 } );
+
+      test.execute( Insert { "a", 0 } );
+      test.execute( Insert { "c", 2 } );
+      test.execute( ReadAll( "abcd" ) );
+      test.execute( FragmentCount { 0 } );
+    }
+
+    {
+      ReassemblerTestHarness test { "overhead ratio", 100000 };
+
+      test.execute( SetLimits( { 0, 8.0 } ) );
+      test.execute( Insert { string( 1000, 'x' ), 1000 } );
+      test.execute( FragmentCount { 1 } ); // one fragment is always kept
+      for ( unsigned i = 0; i < 200; ++i ) {
+        test.execute( Insert { "y", 3000 + 2 * i } );
+      }
+      test.execute( WithinOverheadRatio( 8.0 ) );
+      test.execute( CoalescedFragments( 0 ) );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,124 @@
+#include "byte_stream.hh"
+#include "reassembler.hh"
+#include "test_should_be.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+string read_all( Reader& reader )
+{
+  string out;
+  read( reader, reader.bytes_buffered(), out );
+  return out;
+}
+
+// Feed the same random inserts to a map-based and a ring-based Reassembler, and check they never disagree
+void compare_storage( const size_t input_len, const size_t random_seed, const bool change_capacity )
+{
+  default_random_engine rd { random_seed };
+  const string data = [&] {
+    uniform_int_distribution<char> ud;
+    string ret;
+    for ( size_t i = 0; i < input_len; ++i ) {
+      ret += ud( rd );
+    }
+    return ret;
+  }();
+
+  uniform_int_distribution<uint64_t> capacity_dist { 1, 3000 };
+  const uint64_t capacity = capacity_dist( rd );
+  Reassembler map_ra { ByteStream { capacity }, Reassembler::Storage::Map };
+  Reassembler ring_ra { ByteStream { capacity }, Reassembler::Storage::Ring };
+  string map_out;
+  string ring_out;
+
+  uniform_int_distribution<size_t> len_dist { 0, 700 };
+  uniform_int_distribution<unsigned> action_dist { 0, 19 };
+  while ( map_out.size() < data.size() ) {
+    const size_t next = map_ra.writer().bytes_pushed();
+    const size_t offset = uniform_int_distribution<size_t> { 0, 2 * capacity }( rd );
+    const size_t first_index = next + offset > 300 ? next + offset - 300 : 0;
+    if ( first_index < data.size() ) {
+      const string segment = data.substr( first_index, len_dist( rd ) );
+      const bool is_last = first_index + segment.size() == data.size();
+      map_ra.insert( first_index, segment, is_last );
+      ring_ra.insert( first_index, segment, is_last );
+    }
+
+    test_should_be( ring_ra.bytes_pending(), map_ra.bytes_pending() );
+    test_should_be( ring_ra.writer().bytes_pushed(), map_ra.writer().bytes_pushed() );
+    if ( ring_ra.received_blocks( 4 ) != map_ra.received_blocks( 4 ) ) {
+      throw runtime_error( "map and ring Reassemblers reported different received blocks" );
+    }
+
+    const unsigned action = action_dist( rd );
+    if ( action < 10 ) {
+      map_out += read_all( map_ra.reader() );
+      ring_out += read_all( ring_ra.reader() );
+    } else if ( action == 10 && change_capacity ) {
+      const uint64_t new_capacity = capacity_dist( rd ) * 2;
+      map_ra.reader().set_capacity( new_capacity );
+      ring_ra.reader().set_capacity( new_capacity );
+    }
+  }
+
+  // both storage modes see the same duplicates and holes
+  const auto& map_stats = map_ra.stats();
+  const auto& ring_stats = ring_ra.stats();
+  test_should_be( ring_stats.duplicate_bytes, map_stats.duplicate_bytes );
+  test_should_be( ring_stats.beyond_capacity_bytes, map_stats.beyond_capacity_bytes );
+  test_should_be( ring_stats.peak_bytes_pending, map_stats.peak_bytes_pending );
+  if ( ring_stats.reorder_distance != map_stats.reorder_distance
+       || ring_stats.hole_fill_inserts != map_stats.hole_fill_inserts ) {
+    throw runtime_error( "map and ring Reassemblers reported different statistics" );
+  }
+
+  test_should_be( ring_out.size(), map_out.size() );
+  if ( ring_out != map_out || map_out != data ) {
+    throw runtime_error( "map and ring Reassemblers produced different output" );
+  }
+  if ( not map_ra.reader().is_finished() || not ring_ra.reader().is_finished() ) {
+    throw runtime_error( "Reassembler did not finish the stream" );
+  }
+}
+
+void capacity_growth()
+{
+  // bytes stored ahead of a gap stay in place when the ring is rebuilt for a larger capacity
+  Reassembler ra { ByteStream { 8 }, Reassembler::Storage::Ring };
+  ra.insert( 2, "cdefgh", false );
+  test_should_be( ra.bytes_pending(), uint64_t { 6 } );
+  ra.reader().set_capacity( 200 );
+  ra.insert( 100, "xyz", true );
+  test_should_be( ra.bytes_pending(), uint64_t { 9 } );
+  ra.insert( 0, "ab", false );
+  test_should_be( ra.writer().bytes_pushed(), uint64_t { 8 } );
+  if ( read_all( ra.reader() ) != "abcdefgh" ) {
+    throw runtime_error( "ring Reassembler lost bytes when its capacity grew" );
+  }
+  ra.insert( 8, string( 92, '.' ), false );
+  test_should_be( ra.bytes_pending(), uint64_t { 0 } );
+  test_should_be( ra.writer().is_closed(), true );
+}
+
+int main()
+{
+  try {
+    capacity_growth();
+    for ( size_t seed = 0; seed < 64; ++seed ) {
+      compare_storage( 20000, seed, seed % 2 == 1 );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -80,6 +80,33 @@ int main()
       test.execute( ReadAll(
         { 0x0d, 0x0a, 0x63, 0x61, 0x0a, 0x66, 0x65, 0x20, 0x62, 0x30, 0x0d, 0x62, 0x00, 0x61, 0x00, 0x00 } ) );
     }
+
+    {
+      ReassemblerTestHarness test { "in-order fast path", 10 };
+
+      test.execute( Insert { "abcd", 0 } );
+      test.execute( FastPathInserts( 1 ) );
+      test.execute( Insert { "cdef", 2 } ); // overlaps what was pushed, but the rest is still next in order
+      test.execute( FastPathInserts( 2 ) );
+      test.execute( BytesPushed( 6 ) );
+
+      test.execute( Insert { "ij", 8 } );
+      test.execute( SlowPathInserts( 1 ) );
+      test.execute( Insert { "gh", 6 } ); // in order, but "ij" is pending
+      test.execute( SlowPathInserts( 2 ) );
+      test.execute( BytesPushed( 10 ) );
+      test.execute( BytesPending( 0 ) );
+
+      test.execute( Insert { "xyz", 100 } ); // discarded before either path
+      test.execute( FastPathInserts( 2 ) );
+      test.execute( SlowPathInserts( 2 ) );
+      test.execute( ReadAll( "abcdefghij" ) );
+
+      test.execute( Insert { "ijkl", 8 }.is_last() );
+      test.execute( FastPathInserts( 3 ) );
+      test.execute( ReadAll( "kl" ) );
+      test.execute( IsFinished { true } );
+    }
   } catch ( const exception& e ) {
     cerr << "Exception: " << e.what() << endl;
     return EXIT_FAILURE;
@@ -8,14 +8,41 @@
 #include <iostream>
 #include <queue>
 #include <random>
+#include <string>
 #include <tuple>
+#include <vector>
 
 using namespace std;
 using namespace std::chrono;
 
-void speed_test( const size_t num_chunks,   // NOLINT(bugprone-easily-swappable-parameters)
-                 const size_t capacity,     // NOLINT(bugprone-easily-swappable-parameters)
-                 const size_t random_seed ) // NOLINT(bugprone-easily-swappable-parameters)
+void report( const string& description, size_t bytes, duration<double> test_duration )
+{
+  auto bytes_per_second = static_cast<double>( bytes ) / test_duration.count();
+  auto bits_per_second = 8 * bytes_per_second;
+  auto gigabits_per_second = bits_per_second / 1e9;
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  cout << description << " reached " << fixed << setprecision( 2 ) << gigabits_per_second << " Gbit/s.\n";
+
+  debug_output << "             Reassembler throughput: " << fixed << setprecision( 2 ) << gigabits_per_second
+               << " Gbit/s\n";
+
+  if ( gigabits_per_second < 0.1 ) {
+    throw runtime_error( "Reassembler did not meet minimum speed of 0.1 Gbit/s." );
+  }
+}
+
+string storage_name( Reassembler::Storage storage )
+{
+  return storage == Reassembler::Storage::Map ? "map" : "ring";
+}
+
+void speed_test( const size_t num_chunks,  // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t capacity,    // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t random_seed, // NOLINT(bugprone-easily-swappable-parameters)
+                 const Reassembler::Storage storage )
 {
   // Generate the data to be written
   const string data = [&] {
@@ -36,7 +63,7 @@ void speed_test( const size_t num_chunks,   // NOLINT(bugprone-easily-swappable-
     split_data.emplace( i + 1, data.substr( i + 1, capacity * 2 ), i + 1 + capacity * 2 >= data.size() );
   }
 
-  Reassembler reassembler { ByteStream { capacity } };
+  Reassembler reassembler { ByteStream { capacity }, storage };
 
   string output_data;
   output_data.reserve( data.size() );
@@ -63,28 +90,161 @@ void speed_test( const size_t num_chunks,   // NOLINT(bugprone-easily-swappable-
     throw runtime_error( "Mismatch between data written and read" );
   }
 
-  auto test_duration = duration_cast<duration<double>>( stop_time - start_time );
-  auto bytes_per_second = static_cast<double>( num_chunks * capacity ) / test_duration.count();
-  auto bits_per_second = 8 * bytes_per_second;
-  auto gigabits_per_second = bits_per_second / 1e9;
+  report( storage_name( storage ) + " Reassembler to ByteStream with capacity=" + to_string( capacity ),
+          num_chunks * capacity,
+          duration_cast<duration<double>>( stop_time - start_time ) );
+}
 
-  fstream debug_output;
-  debug_output.open( "/dev/tty" );
+// Deliver overlapping segments in a random order within each receive window, so that many pieces are pending.
+// Each delivery is lost with probability loss_percent, and lost segments are resent (in a new random order)
+// until the whole window has arrived.
+void reorder_speed_test( const size_t num_segments,    // NOLINT(bugprone-easily-swappable-parameters)
+                         const size_t segment_size,    // NOLINT(bugprone-easily-swappable-parameters)
+                         const size_t window_segments, // NOLINT(bugprone-easily-swappable-parameters)
+                         const unsigned loss_percent,
+                         const size_t random_seed, // NOLINT(bugprone-easily-swappable-parameters)
+                         const Reassembler::Storage storage )
+{
+  default_random_engine rd { random_seed };
+  const string data = [&] {
+    uniform_int_distribution<char> ud;
+    string ret;
+    for ( size_t i = 0; i < num_segments * segment_size; ++i ) {
+      ret += ud( rd );
+    }
+    return ret;
+  }();
 
-  cout << "Reassembler to ByteStream with capacity=" << capacity << " reached " << fixed << setprecision( 2 )
-       << gigabits_per_second << " Gbit/s.\n";
+  // each segment also carries the first few bytes of its successor
+  const size_t overlap = segment_size / 8;
+  vector<tuple<uint64_t, string, bool>> split_data;
+  uniform_int_distribution<unsigned> loss { 0, 99 };
+  for ( size_t window = 0; window < num_segments; window += window_segments ) {
+    vector<size_t> unsent;
+    for ( size_t seg = window; seg < min( window + window_segments, num_segments ); ++seg ) {
+      unsent.push_back( seg );
+    }
+    while ( not unsent.empty() ) {
+      shuffle( unsent.begin(), unsent.end(), rd );
+      vector<size_t> lost;
+      for ( const size_t seg : unsent ) {
+        if ( loss( rd ) < loss_percent ) {
+          lost.push_back( seg );
+          continue;
+        }
+        const size_t i = seg * segment_size;
+        const size_t len = min( segment_size + overlap, data.size() - i );
+        split_data.emplace_back( i, data.substr( i, len ), i + len == data.size() );
+      }
+      unsent = move( lost );
+    }
+  }
 
-  debug_output << "             Reassembler throughput: " << fixed << setprecision( 2 ) << gigabits_per_second
-               << " Gbit/s\n";
+  Reassembler reassembler { ByteStream { window_segments * segment_size }, storage };
 
-  if ( gigabits_per_second < 0.1 ) {
-    throw runtime_error( "Reassembler did not meet minimum speed of 0.1 Gbit/s." );
+  string output_data;
+  output_data.reserve( data.size() );
+
+  const auto start_time = steady_clock::now();
+  for ( auto& [first_index, segment, is_last] : split_data ) {
+    reassembler.insert( first_index, move( segment ), is_last );
+
+    while ( reassembler.reader().bytes_buffered() ) {
+      output_data += reassembler.reader().peek();
+      reassembler.reader().pop( output_data.size() - reassembler.reader().bytes_popped() );
+    }
   }
+  const auto stop_time = steady_clock::now();
+
+  if ( not reassembler.reader().is_finished() ) {
+    throw runtime_error( "Reassembler did not close ByteStream when finished" );
+  }
+
+  if ( data != output_data ) {
+    throw runtime_error( "Mismatch between data written and read" );
+  }
+
+  report( storage_name( storage ) + " Reassembler with " + to_string( window_segments ) + " reordered segments of "
+            + to_string( segment_size ) + " bytes and " + to_string( loss_percent ) + "% loss",
+          data.size(),
+          duration_cast<duration<double>>( stop_time - start_time ) );
+}
+
+// Deliver bursts of segments that are shuffled within each burst, either one insert() at a time or as one
+// insert_batch() per burst
+void burst_speed_test( const size_t num_segments, // NOLINT(bugprone-easily-swappable-parameters)
+                       const size_t segment_size, // NOLINT(bugprone-easily-swappable-parameters)
+                       const size_t burst_size,   // NOLINT(bugprone-easily-swappable-parameters)
+                       const bool batched,
+                       const size_t random_seed, // NOLINT(bugprone-easily-swappable-parameters)
+                       const Reassembler::Storage storage )
+{
+  default_random_engine rd { random_seed };
+  const string data = [&] {
+    uniform_int_distribution<char> ud;
+    string ret;
+    for ( size_t i = 0; i < num_segments * segment_size; ++i ) {
+      ret += ud( rd );
+    }
+    return ret;
+  }();
+
+  vector<vector<Reassembler::Substring>> bursts;
+  for ( size_t burst = 0; burst < num_segments; burst += burst_size ) {
+    auto& segments = bursts.emplace_back();
+    for ( size_t seg = burst; seg < min( burst + burst_size, num_segments ); ++seg ) {
+      const size_t i = seg * segment_size;
+      segments.push_back( { i, data.substr( i, segment_size ), i + segment_size == data.size() } );
+    }
+    shuffle( segments.begin(), segments.end(), rd );
+  }
+
+  Reassembler reassembler { ByteStream { 2 * burst_size * segment_size }, storage };
+
+  string output_data;
+  output_data.reserve( data.size() );
+
+  const auto start_time = steady_clock::now();
+  for ( auto& segments : bursts ) {
+    if ( batched ) {
+      reassembler.insert_batch( segments );
+    } else {
+      for ( auto& [first_index, segment, is_last] : segments ) {
+        reassembler.insert( first_index, move( segment ), is_last );
+      }
+    }
+
+    while ( reassembler.reader().bytes_buffered() ) {
+      output_data += reassembler.reader().peek();
+      reassembler.reader().pop( output_data.size() - reassembler.reader().bytes_popped() );
+    }
+  }
+  const auto stop_time = steady_clock::now();
+
+  if ( not reassembler.reader().is_finished() ) {
+    throw runtime_error( "Reassembler did not close ByteStream when finished" );
+  }
+
+  if ( data != output_data ) {
+    throw runtime_error( "Mismatch between data written and read" );
+  }
+
+  const string stored = to_string( reassembler.stats().slow_path_inserts );
+  report( storage_name( storage ) + " Reassembler with bursts of " + to_string( burst_size )
+            + ( batched ? " batched" : " single" ) + " inserts (" + stored + " stored)",
+          data.size(),
+          duration_cast<duration<double>>( stop_time - start_time ) );
 }
 
 void program_body()
 {
-  speed_test( 10000, 1500, 1370 );
+  for ( const auto storage : { Reassembler::Storage::Map, Reassembler::Storage::Ring } ) {
+    speed_test( 10000, 1500, 1370, storage );
+    reorder_speed_test( 20000, 1000, 256, 0, 1370, storage );
+    reorder_speed_test( 20000, 1000, 256, 30, 1370, storage );
+    burst_speed_test( 20000, 1000, 16, false, 1370, storage );
+    burst_speed_test( 20000, 1000, 16, true, 1370, storage );
+  }
 }
 
 int main()
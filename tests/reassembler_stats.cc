@@ -0,0 +1,137 @@
+#include "reassembler_test_harness.hh"
+
+#include <algorithm>
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+struct DuplicateBytes : public ConstExpectNumber<Reassembler, uint64_t>
+{
+  using ConstExpectNumber::ConstExpectNumber;
+  std::string name() const override { return "stats().duplicate_bytes"; }
+  uint64_t value( const Reassembler& r ) const override { return r.stats().duplicate_bytes; }
+};
+
+struct BeyondCapacityBytes : public ConstExpectNumber<Reassembler, uint64_t>
+{
+  using ConstExpectNumber::ConstExpectNumber;
+  std::string name() const override { return "stats().beyond_capacity_bytes"; }
+  uint64_t value( const Reassembler& r ) const override { return r.stats().beyond_capacity_bytes; }
+};
+
+struct PeakBytesPending : public ConstExpectNumber<Reassembler, uint64_t>
+{
+  using ConstExpectNumber::ConstExpectNumber;
+  std::string name() const override { return "stats().peak_bytes_pending"; }
+  uint64_t value( const Reassembler& r ) const override { return r.stats().peak_bytes_pending; }
+};
+
+struct MemoryUsage : public ConstExpectNumber<Reassembler, uint64_t>
+{
+  using ConstExpectNumber::ConstExpectNumber;
+  std::string name() const override { return "memory_usage"; }
+  uint64_t value( const Reassembler& r ) const override { return r.memory_usage(); }
+};
+
+struct HistogramIs : public Expectation<Reassembler>
+{
+  Reassembler::Stats::Histogram Reassembler::Stats::* histogram_;
+  std::string name_;
+  Reassembler::Stats::Histogram expected_ {};
+
+  // `buckets` lists the expected count of each bucket from 0; later buckets are expected to be empty
+  HistogramIs( Reassembler::Stats::Histogram Reassembler::Stats::* histogram,
+               std::string name,
+               std::initializer_list<uint64_t> buckets )
+    : histogram_( histogram ), name_( move( name ) )
+  {
+    ranges::copy( buckets, expected_.begin() );
+  }
+
+  std::string description() const override { return "stats()." + name_ + " = " + print( expected_ ); }
+  void execute( Reassembler& r ) const override
+  {
+    if ( r.stats().*histogram_ != expected_ ) {
+      throw ExpectationViolation( "stats()." + name_ + " was " + print( r.stats().*histogram_ ) );
+    }
+  }
+
+  static std::string print( const Reassembler::Stats::Histogram& histogram )
+  {
+    size_t used = histogram.size();
+    while ( used > 0 && histogram.at( used - 1 ) == 0 ) {
+      --used;
+    }
+    std::string ret = "{";
+    for ( size_t i = 0; i < used; ++i ) {
+      ret += ( i == 0 ? " " : ", " ) + std::to_string( histogram.at( i ) );
+    }
+    return ret + " }";
+  }
+};
+
+int main()
+{
+  try {
+    {
+      ReassemblerTestHarness test { "duplicates, reordering and holes", 10 };
+
+      test.execute( Insert { "cd", 2 } ); // opens a hole at index 0
+      test.execute( Insert { "c", 2 } );
+      test.execute( DuplicateBytes { 1 } );
+      test.execute( Insert { "bcde", 1 } ); // supersedes "cd"
+      test.execute( DuplicateBytes { 3 } );
+      test.execute( PeakBytesPending { 4 } );
+      test.execute( Insert { "a", 0 } ); // fills the hole, three inserts after it opened
+      test.execute( BytesPending { 0 } );
+      test.execute( HistogramIs { &Reassembler::Stats::reorder_distance, "reorder_distance", { 1, 1, 2 } } );
+      test.execute( HistogramIs { &Reassembler::Stats::hole_fill_inserts, "hole_fill_inserts", { 0, 0, 1 } } );
+
+      test.execute( Insert { "abcdefg", 0 } ); // five bytes were already pushed
+      test.execute( DuplicateBytes { 8 } );
+      test.execute( Insert { "hijklmnop", 7 } ); // only three bytes of room left
+      test.execute( BeyondCapacityBytes { 6 } );
+      test.execute( FastPathInserts { 2 } );
+      test.execute( SlowPathInserts { 4 } );
+      test.execute( ReadAll( "abcdefghij" ) );
+    }
+
+    {
+      ReassemblerTestHarness test { "a hole reopens behind stored bytes", 100 };
+
+      test.execute( Insert { "b", 1 } );
+      test.execute( Insert { "d", 3 } );
+      test.execute( Insert { "a", 0 } ); // fills the first hole; "d" still waits behind another
+      test.execute( HistogramIs { &Reassembler::Stats::hole_fill_inserts, "hole_fill_inserts", { 0, 0, 1 } } );
+      test.execute( Insert { "x", 50 } );
+      test.execute( Insert { "y", 55 } );
+      test.execute( Insert { "z", 60 } );
+      test.execute( Insert { "c", 2 } ); // four inserts after the second hole opened
+      test.execute( HistogramIs { &Reassembler::Stats::hole_fill_inserts, "hole_fill_inserts", { 0, 0, 1, 1 } } );
+      test.execute(
+        HistogramIs { &Reassembler::Stats::reorder_distance, "reorder_distance", { 2, 1, 1, 0, 0, 0, 3 } } );
+      test.execute( ReadAll( "abcd" ) );
+    }
+
+    {
+      ReassemblerTestHarness test { "a substring covered by the pieces on either side costs no memory", 100 };
+
+      test.execute( Insert { "abc", 2 } );
+      test.execute( Insert { "defghijk", 5 } );
+      for ( unsigned i = 0; i < 5; ++i ) {
+        test.execute( Insert { "cdefgh", 3 } );
+      }
+      test.execute( DuplicateBytes { 30 } );
+      test.execute( BytesPending { 11 } );
+      test.execute( Insert { "ab", 0 } );
+      test.execute( ReadAll( "ababcdefghijk" ) );
+      test.execute( MemoryUsage { 0 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
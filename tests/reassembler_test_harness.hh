@@ -49,6 +49,20 @@ struct BytesPending : public ConstExpectNumber<Reassembler, uint64_t>
   uint64_t value( const Reassembler& r ) const override { return r.bytes_pending(); }
 };
 
+struct FastPathInserts : public ConstExpectNumber<Reassembler, uint64_t>
+{
+  using ConstExpectNumber::ConstExpectNumber;
+  std::string name() const override { return "stats().fast_path_inserts"; }
+  uint64_t value( const Reassembler& r ) const override { return r.stats().fast_path_inserts; }
+};
+
+struct SlowPathInserts : public ConstExpectNumber<Reassembler, uint64_t>
+{
+  using ConstExpectNumber::ConstExpectNumber;
+  std::string name() const override { return "stats().slow_path_inserts"; }
+  uint64_t value( const Reassembler& r ) const override { return r.stats().slow_path_inserts; }
+};
+
 struct Insert : public Action<Reassembler>
 {
   std::string data_;
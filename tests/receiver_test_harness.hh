@@ -40,10 +40,12 @@ struct DirectByteStreamTest : public TestStep<TCPReceiver>
 class TCPReceiverTestHarness : public TestHarness<TCPReceiver>
 {
 public:
-  TCPReceiverTestHarness( std::string test_name, uint64_t capacity )
+  TCPReceiverTestHarness( std::string test_name,
+                          uint64_t capacity,
+                          Reassembler::Storage storage = Reassembler::Storage::Map )
     : TestHarness( move( test_name ),
                    "capacity=" + std::to_string( capacity ),
-                   { TCPReceiver { Reassembler { ByteStream { capacity } } } } )
+                   { TCPReceiver { Reassembler { ByteStream { capacity }, storage } } } )
   {}
 
   template<std::derived_from<TestStep<Reassembler>> T>
@@ -118,6 +120,15 @@ struct HasAckno : public ExpectBool<TCPReceiver>
   bool value( TCPReceiver& rs ) const override { return rs.send().ackno.has_value(); }
 };
 
+struct SetAutotuneLimit : public Action<TCPReceiver>
+{
+  uint64_t limit_;
+
+  explicit SetAutotuneLimit( uint64_t limit ) : limit_( limit ) {}
+  std::string description() const override { return "set_autotune_limit( " + std::to_string( limit_ ) + " )"; }
+  void execute( TCPReceiver& rs ) const override { rs.set_autotune_limit( limit_ ); }
+};
+
 struct SegmentArrives : public Action<TCPReceiver>
 {
   TCPSenderMessage msg_ {};
@@ -0,0 +1,142 @@
+#include "receiver_test_harness.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+using SackBlocks = vector<pair<Wrap32, Wrap32>>;
+
+string sack_string( const SackBlocks& sack )
+{
+  string ret = "[";
+  for ( const auto& [left, right] : sack ) {
+    ret += " " + to_string( left ) + "-" + to_string( right );
+  }
+  return ret + " ]";
+}
+
+struct SetSackBlocks : public Action<TCPReceiver>
+{
+  size_t max_blocks_;
+
+  explicit SetSackBlocks( size_t max_blocks ) : max_blocks_( max_blocks ) {}
+  std::string description() const override { return "set_sack_blocks( " + std::to_string( max_blocks_ ) + " )"; }
+  void execute( TCPReceiver& rs ) const override { rs.set_sack_blocks( max_blocks_ ); }
+};
+
+struct ExpectSack : public Expectation<TCPReceiver>
+{
+  SackBlocks sack_;
+
+  explicit ExpectSack( SackBlocks sack ) : sack_( move( sack ) ) {}
+  std::string description() const override { return "SACK blocks = " + sack_string( sack_ ); }
+  void execute( TCPReceiver& rs ) const override
+  {
+    const auto sack = rs.send().sack;
+    if ( sack != sack_ ) {
+      throw ExpectationViolation( "SACK blocks were " + sack_string( sack ) );
+    }
+  }
+};
+
+void segment_round_trip()
+{
+  TCPSegment seg;
+  seg.udinfo = { 1234, 80, 0 };
+  seg.message.sender.seqno = Wrap32 { 1000 };
+  seg.message.sender.payload = "hello";
+  seg.message.receiver.ackno = Wrap32 { 77 };
+  seg.message.receiver.window_size = 4000;
+  seg.message.receiver.sack = { { Wrap32 { 100 }, Wrap32 { 200 } }, { Wrap32 { UINT32_MAX - 5 }, Wrap32 { 10 } } };
+  seg.compute_checksum( 0 );
+
+  if ( seg.header_length() != 20 + 4 + 16 ) {
+    throw runtime_error( "unexpected header length " + to_string( seg.header_length() ) );
+  }
+
+  TCPSegment parsed;
+  if ( not parse( parsed, serialize( seg ), 0 ) ) {
+    throw runtime_error( "could not parse a segment with SACK blocks" );
+  }
+  if ( parsed.message.receiver.sack != seg.message.receiver.sack ) {
+    throw runtime_error( "SACK blocks changed in a round trip: " + sack_string( parsed.message.receiver.sack ) );
+  }
+  if ( parsed.message.sender.payload != "hello" or parsed.message.receiver.window_size != 4000 ) {
+    throw runtime_error( "segment with SACK blocks was not parsed correctly" );
+  }
+
+  // a segment without SACK blocks keeps the minimal header
+  seg.message.receiver.sack.clear();
+  if ( seg.header_length() != 20 or serialize( seg ).front().size() != 20 ) {
+    throw runtime_error( "segment without SACK blocks should have a 20-byte header" );
+  }
+}
+
+int main()
+{
+  try {
+    segment_round_trip();
+
+    {
+      const uint32_t isn = 1000;
+      TCPReceiverTestHarness test { "SACK blocks off by default", 4000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 3 ).with_data( "cd" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 1 } } );
+      test.execute( ExpectSack { {} } );
+    }
+
+    {
+      const uint32_t isn = UINT32_MAX - 3;
+      TCPReceiverTestHarness test { "SACK blocks report holes", 4000 };
+      test.execute( SetSackBlocks { 2 } );
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( ExpectSack { {} } );
+
+      test.execute( SegmentArrives {}.with_seqno( isn + 3 ).with_data( "cd" ) );
+      test.execute( ExpectSack { { { Wrap32 { isn + 3 }, Wrap32 { isn + 5 } } } } );
+
+      test.execute( SegmentArrives {}.with_seqno( isn + 5 ).with_data( "ef" ) ); // adjacent: one block
+      test.execute( SegmentArrives {}.with_seqno( isn + 9 ).with_data( "ij" ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 12 ).with_data( "l" ) );
+      test.execute( ExpectSack { { { Wrap32 { isn + 3 }, Wrap32 { isn + 7 } },
+                                   { Wrap32 { isn + 9 }, Wrap32 { isn + 11 } } } } );
+
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "ab" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 7 } } );
+      test.execute( ExpectSack { { { Wrap32 { isn + 9 }, Wrap32 { isn + 11 } },
+                                   { Wrap32 { isn + 12 }, Wrap32 { isn + 13 } } } } );
+    }
+
+    {
+      const uint32_t isn = 5;
+      TCPReceiverTestHarness test { "SACK blocks from ring storage", 64, Reassembler::Storage::Ring };
+      test.execute( SetSackBlocks { 4 } );
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( string( 60, 'x' ) ) );
+      test.execute( ReadAll { string( 60, 'x' ) } );
+
+      // the window now wraps around the end of the ring
+      test.execute( SegmentArrives {}.with_seqno( isn + 63 ).with_data( "cdef" ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 68 ).with_data( "h" ) );
+      test.execute( ExpectSack { { { Wrap32 { isn + 63 }, Wrap32 { isn + 67 } },
+                                   { Wrap32 { isn + 68 }, Wrap32 { isn + 69 } } } } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 61 ).with_data( "ab" ) );
+      test.execute( ExpectSack { { { Wrap32 { isn + 68 }, Wrap32 { isn + 69 } } } } );
+      test.execute( ReadAll { "abcdef" } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
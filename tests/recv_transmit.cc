@@ -39,6 +39,8 @@ int main()
       test.execute( BytesPending { 0 } );
       test.execute( BytesPushed { 8 } );
       test.execute( ReadAll { "efgh" } );
+      test.execute( FastPathInserts { 2 } );
+      test.execute( SlowPathInserts { 0 } );
     }
 
     {
@@ -105,6 +105,31 @@ int main()
       test.execute( BytesPending( 0 ) );
     }
 
+    {
+      const uint32_t isn = 23452;
+      TCPReceiverTestHarness test { "window autotunes as the application keeps up", 4 };
+      test.execute( SetAutotuneLimit { 16 } );
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abcd" ) );
+      test.execute( ExpectWindow { 0 } );
+      test.execute( ReadAll { "abcd" } );
+      test.execute( ExpectWindow { 4 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 5 ).with_data( "efgh" ) );
+      test.execute( ExpectWindow { 4 } ); // capacity doubled to 8
+      test.execute( ReadAll { "efgh" } );
+      test.execute( ExpectWindow { 8 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 9 ).with_data( "ijklmnop" ) );
+      test.execute( ReadAll { "ijklmnop" } );
+      test.execute( ExpectWindow { 8 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 17 ).with_data( "q" ) );
+      test.execute( ExpectWindow { 15 } ); // capacity doubled to 16, the limit
+      test.execute( ReadAll { "q" } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 18 ).with_data( "rstuvwxyz0123456" ) );
+      test.execute( ReadAll { "rstuvwxyz0123456" } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 34 ).with_data( "7" ) );
+      test.execute( ExpectWindow { 15 } );
+    }
+
   } catch ( const exception& e ) {
     cerr << e.what() << endl;
     return 1;
@@ -0,0 +1,103 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+struct ExpectMSS : public ExpectNumber<SenderAndOutput, size_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "mss"; }
+  size_t value( SenderAndOutput& ss ) const override { return ss.sender.mss(); }
+};
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.mss = 1460;
+
+      TCPSenderTestHarness test { "Segments are no longer than the configured MSS", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 10000 ) );
+      test.execute( Push { string( 4000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1460 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1460 ).with_seqno( isn + 1461 ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1080 ).with_seqno( isn + 2921 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.probe_mss = 1460;
+
+      TCPSenderTestHarness test { "An acknowledged probe raises the MSS", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 10000 ) );
+      test.execute( Push { string( 1000, 'x' ) } ); // not enough data waiting to fill a probe
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( Push { string( 3000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1460 ).with_seqno( isn + 1001 ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1000 ).with_seqno( isn + 2461 ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 540 ).with_seqno( isn + 3461 ) );
+      test.execute( ExpectMSS { 1000 } );
+      test.execute( AckReceived { Wrap32 { isn + 4001 } }.with_win( 10000 ) );
+      test.execute( ExpectMSS { 1460 } );
+      test.execute( Push { string( 3000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1460 ).with_seqno( isn + 4001 ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1460 ).with_seqno( isn + 5461 ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 80 ).with_seqno( isn + 6921 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.probe_mss = 9000;
+
+      TCPSenderTestHarness test { "A lost probe is resent in MSS-sized segments without backoff", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 20000 ) );
+      test.execute( Push { string( 9500, 'x' ) } );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 9000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 500 ).with_seqno( isn + 9001 ) );
+      test.execute( Tick { cfg.rt_timeout } );
+      for ( uint32_t i = 0; i < 9; ++i ) {
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1000 ).with_seqno( isn + 1 + 1000 * i ) );
+      }
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectConsecutiveRetransmissions { 0 } );
+      test.execute( AckReceived { Wrap32 { isn + 9501 } }.with_win( 20000 ) );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+      test.execute( ExpectMSS { 1000 } );
+
+      // the next probe splits the difference
+      test.execute( Push { string( 6000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 5000 ).with_seqno( isn + 9501 ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1000 ).with_seqno( isn + 14501 ) );
+      test.execute( AckReceived { Wrap32 { isn + 15501 } }.with_win( 20000 ) );
+      test.execute( ExpectMSS { 5000 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -11,6 +11,27 @@
 
 using namespace std;
 
+struct ExpectFastRetransmissions : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "stats().fast_retransmissions"; }
+  uint64_t value( SenderAndOutput& ss ) const override { return ss.sender.stats().fast_retransmissions; }
+};
+
+struct ExpectTimeoutRetransmissions : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "stats().timeout_retransmissions"; }
+  uint64_t value( SenderAndOutput& ss ) const override { return ss.sender.stats().timeout_retransmissions; }
+};
+
+struct ExpectDuplicateAcks : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "stats().duplicate_acks"; }
+  uint64_t value( SenderAndOutput& ss ) const override { return ss.sender.stats().duplicate_acks; }
+};
+
 int main()
 {
   try {
@@ -200,6 +221,61 @@ int main()
       test.execute( ExpectSeqnosInFlight { 0 } );
       test.execute( HasError { false } );
     }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.fast_retransmit = true;
+
+      TCPSenderTestHarness test { "The third duplicate ACK resends the oldest segment at once", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 3000 ) );
+      test.execute( Push { string( 3000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1001 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 2001 ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 3000 ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 3000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 3000 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 3000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectDuplicateAcks { 4 } );
+      test.execute( ExpectFastRetransmissions { 1 } );
+      test.execute( ExpectConsecutiveRetransmissions { 0 } );
+      test.execute( AckReceived { Wrap32 { isn + 3001 } }.with_win( 3000 ) );
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectTimeoutRetransmissions { 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "Without fast retransmit, duplicate ACKs wait for the timer", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 3000 ) );
+      test.execute( Push { string( 3000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1001 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 2001 ) );
+      for ( int i = 0; i < 3; ++i ) {
+        test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 3000 ) );
+      }
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 2000 ) ); // a window update is no duplicate
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectDuplicateAcks { 3 } );
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectFastRetransmissions { 0 } );
+      test.execute( ExpectTimeoutRetransmissions { 1 } );
+    }
   } catch ( const exception& e ) {
     cerr << e.what() << endl;
     return 1;
@@ -0,0 +1,193 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+struct ExpectRTO : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "current_RTO_ms"; }
+  uint64_t value( SenderAndOutput& ss ) const override { return ss.sender.current_RTO_ms(); }
+};
+
+struct ExpectRTTSamples : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "rtt_estimator()->samples()"; }
+  uint64_t value( SenderAndOutput& ss ) const override { return ss.sender.rtt_estimator()->samples(); }
+};
+
+struct SetRTTEstimation : public Action<SenderAndOutput>
+{
+  uint64_t min_RTO_ms_;
+  uint64_t max_RTO_ms_;
+
+  SetRTTEstimation( uint64_t min_RTO_ms, uint64_t max_RTO_ms )
+    : min_RTO_ms_( min_RTO_ms ), max_RTO_ms_( max_RTO_ms )
+  {}
+  std::string description() const override
+  {
+    return "set_rtt_estimation(" + std::to_string( min_RTO_ms_ ) + ", " + std::to_string( max_RTO_ms_ ) + ")";
+  }
+  void execute( SenderAndOutput& ss ) const override { ss.sender.set_rtt_estimation( min_RTO_ms_, max_RTO_ms_ ); }
+};
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.min_rto = 200;
+
+      TCPSenderTestHarness test { "The RTO follows the measured RTT, and backs off on timeout", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 1000 ) );
+      test.execute( ExpectRTTSamples { 1 } );
+      test.execute( ExpectRTO { 300 } ); // SRTT 100 + 4 * RTTVAR 50
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_payload_size( 3 ).with_seqno( isn + 1 ) );
+      test.execute( Tick { 299 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_payload_size( 3 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectRTO { 600 } );
+
+      // Karn's algorithm: no sample from a retransmitted segment, and the backed-off RTO stays
+      test.execute( Tick { 50 } );
+      test.execute( AckReceived { Wrap32 { isn + 4 } }.with_win( 1000 ) );
+      test.execute( ExpectRTTSamples { 1 } );
+      test.execute( ExpectRTO { 600 } );
+      test.execute( Push { "def" } );
+      test.execute( ExpectMessage {}.with_payload_size( 3 ).with_seqno( isn + 4 ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { Wrap32 { isn + 7 } }.with_win( 1000 ) );
+      test.execute( ExpectRTTSamples { 2 } );
+      test.execute( ExpectRTO { 250 } ); // SRTT 100 + 4 * RTTVAR 37.5
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.min_rto = 200;
+
+      TCPSenderTestHarness test { "Only one segment at a time is timed", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( Tick { 40 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 1000 ) );
+      test.execute( Push { "abc" } );
+      test.execute( Tick { 10 } );
+      test.execute( Push { "def" } );
+      test.execute( Tick { 30 } );
+      test.execute( AckReceived { Wrap32 { isn + 4 } }.with_win( 1000 ) );
+      test.execute( ExpectRTTSamples { 2 } );
+      test.execute( AckReceived { Wrap32 { isn + 7 } }.with_win( 1000 ) );
+      test.execute( ExpectRTTSamples { 2 } );
+      test.execute( ExpectRTO { 200 } ); // SRTT 40 + 4 * RTTVAR 20, raised to the minimum
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.min_rto = 200;
+      cfg.max_rto = 3000;
+
+      TCPSenderTestHarness test { "The backed-off RTO stops at the maximum", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( Tick { 1000 } );
+      test.execute( ExpectRTO { 2000 } );
+      test.execute( Tick { 2000 } );
+      test.execute( ExpectRTO { 3000 } );
+      test.execute( Tick { 3000 } );
+      test.execute( ExpectRTO { 3000 } );
+      test.execute( ExpectConsecutiveRetransmissions { 3 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "Without RTT estimation, the RTO stays at its initial value", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 1000 ) );
+      test.execute( ExpectRTO { cfg.rt_timeout } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.min_rto = 200;
+
+      TCPSenderTestHarness test { "Turning RTT estimation off drops the measurement in progress", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( Tick { 100 } );
+      test.execute( SetRTTEstimation { 0, cfg.max_rto } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 1000 ) );
+      test.execute( ExpectRTO { cfg.rt_timeout } );
+      test.execute( SetRTTEstimation { cfg.min_rto, cfg.max_rto } );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_payload_size( 3 ).with_seqno( isn + 1 ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { Wrap32 { isn + 4 } }.with_win( 1000 ) );
+      test.execute( ExpectRTTSamples { 1 } );
+      test.execute( ExpectRTO { 300 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.min_rto = 200;
+      cfg.sack_retransmit = true;
+
+      TCPSenderTestHarness test { "With SACK, a segment above a hole is sampled when SACKed", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 3000 ) );
+      test.execute( Push { string( 2000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1001 ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { Wrap32 { isn + 1001 } }.with_win( 3000 ) );
+      test.execute( ExpectRTTSamples { 2 } );
+      test.execute( ExpectRTO { 250 } );
+      test.execute( Push { string( 1000, 'y' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 2001 ) );
+
+      // the segment at 1001 was lost: resending it leaves the measurement of the one at 2001 running
+      test.execute( Tick { 250 } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1001 ) );
+      test.execute( ExpectRTO { 500 } );
+      test.execute( Tick { 50 } );
+      test.execute( Receive { { isn + 1001, 3000, false, { { isn + 2001, isn + 3001 } } } } );
+      test.execute( ExpectRTTSamples { 3 } );
+      test.execute( ExpectRTO { 438 } ); // SRTT 125 + 4 * RTTVAR 78.125
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,145 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+struct ExpectSelectiveRetransmissions : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "stats().selective_retransmissions"; }
+  uint64_t value( SenderAndOutput& ss ) const override { return ss.sender.stats().selective_retransmissions; }
+};
+
+// An ACK of `ackno` that also reports SACK blocks, given as offsets from the ISN
+Receive sack( Wrap32 isn, uint32_t ackno, const vector<pair<uint32_t, uint32_t>>& blocks, uint16_t window = 6000 )
+{
+  TCPReceiverMessage msg { isn + ackno, window, false, {} };
+  for ( const auto& [left, right] : blocks ) {
+    msg.sack.emplace_back( isn + left, isn + right );
+  }
+  return Receive { msg };
+}
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.sack_retransmit = true;
+
+      TCPSenderTestHarness test { "Holes are resent once SACK blocks show them lost", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 6000 ) );
+      test.execute( Push { string( 6000, 'x' ) } );
+      for ( uint32_t i = 0; i < 6; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 1000 * i ) );
+      }
+
+      // the segments at 1 and 2001 were lost
+      test.execute( sack( isn, 1, { { 1001, 2001 } } ) );
+      test.execute( sack( isn, 1, { { 1001, 2001 }, { 3001, 4001 } } ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( sack( isn, 1, { { 1001, 2001 }, { 3001, 5001 } } ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( sack( isn, 1, { { 1001, 2001 }, { 3001, 6001 } } ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 2001 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSelectiveRetransmissions { 2 } );
+
+      // after a timeout, the holes already resent become eligible again
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( sack( isn, 1, { { 1001, 2001 }, { 3001, 6001 } } ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 2001 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( sack( isn, 2001, { { 3001, 6001 } } ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 6001 } }.with_win( 6000 ) );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+      test.execute( ExpectSelectiveRetransmissions { 3 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.sack_retransmit = true;
+
+      TCPSenderTestHarness test { "Resent holes stay within the window", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 6000 ) );
+      test.execute( Push { string( 6000, 'x' ) } );
+      for ( uint32_t i = 0; i < 6; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 1000 * i ) );
+      }
+
+      // the segments at 1 and 1001 were lost, and the window shrank to one segment
+      test.execute( sack( isn, 1, { { 2001, 6001 } }, 1000 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( sack( isn, 1, { { 2001, 6001 } }, 1000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( sack( isn, 1001, { { 2001, 6001 } }, 1000 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1001 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSelectiveRetransmissions { 2 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.sack_retransmit = true;
+
+      TCPSenderTestHarness test { "A timeout forgets what the peer SACKed, in case it reneged", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 6000 ) );
+      test.execute( Push { string( 6000, 'x' ) } );
+      for ( uint32_t i = 0; i < 6; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 1000 * i ) );
+      }
+      test.execute( sack( isn, 1, { { 1001, 6001 } } ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+
+      // the peer discards what it SACKed, and its next ACK says nothing of it
+      test.execute( sack( isn, 1001, {} ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1001 ) );
+      test.execute( sack( isn, 2001, {}, 7000 ) );
+      test.execute( Push { string( 3000, 'y' ) } );
+      for ( uint32_t i = 0; i < 3; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 6001 + 1000 * i ) );
+      }
+
+      // new SACK blocks show the discarded segments lost, and they go out without waiting for the timer
+      test.execute( sack( isn, 2001, { { 6001, 9001 } }, 7000 ) );
+      for ( uint32_t i = 0; i < 4; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 2001 + 1000 * i ) );
+      }
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSelectiveRetransmissions { 5 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
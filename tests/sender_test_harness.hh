@@ -7,6 +7,7 @@
 #include "tcp_sender.hh"
 #include "wrapping_integers.hh"
 
+#include <algorithm>
 #include <optional>
 #include <queue>
 #include <sstream>
@@ -17,6 +18,7 @@ const unsigned int DEFAULT_TEST_WINDOW = 137;
 struct SenderAndOutput
 {
   TCPSender sender;
+  size_t max_payload_size { TCPConfig::MAX_PAYLOAD_SIZE }; // the larger of the MSS and the MTU probing limit
   std::queue<TCPSenderMessage> output {};
 
   auto make_transmit()
@@ -340,7 +342,7 @@ struct ExpectMessage : public Expectation<SenderAndOutput>
     if ( payload_size.has_value() and seg.payload.size() != payload_size.value() ) {
       throw ExpectationViolation( "payload_size", payload_size.value(), seg.payload.size() );
     }
-    if ( seg.payload.size() > TCPConfig::MAX_PAYLOAD_SIZE ) {
+    if ( seg.payload.size() > ss.max_payload_size ) {
       throw ExpectationViolation( "payload has length (" + std::to_string( seg.payload.size() )
                                   + ") greater than the maximum" );
     }
@@ -359,6 +361,14 @@ public:
   TCPSenderTestHarness( std::string name, TCPConfig config )
     : TestHarness( move( name ),
                    "initial_RTO_ms=" + to_string( config.rt_timeout ),
-                   { TCPSender { ByteStream { config.send_capacity }, config.isn, config.rt_timeout } } )
+                   { make_sender( config ), std::max( config.mss, config.probe_mss ) } )
   {}
+
+private:
+  static TCPSender make_sender( const TCPConfig& config )
+  {
+    TCPSender sender { ByteStream { config.send_capacity }, config.isn, config.rt_timeout };
+    sender.configure( config );
+    return sender;
+  }
 };
@@ -0,0 +1,230 @@
+#pragma once
+
+#include "ipv4_datagram.hh"
+#include "parser.hh"
+#include "tcp_config.hh"
+#include "tcp_over_ip.hh"
+#include "tcp_peer.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Two TCPPeers joined by an in-memory link, for end-to-end benchmarks. Each message is wrapped in an IPv4
+// datagram and serialized, as it would be for a TUN device, and parsed (checksums and all) on the other side.
+// Datagrams longer than the link's MTU, or picked by the loss rate of their direction, are dropped; the rest
+// arrive after the link's one-way delay. With a bandwidth set, each direction first goes through a bottleneck
+// that sends one datagram at a time and queues the rest, up to a limit past which it drops them. Simulated
+// time passes only while nothing is due for delivery, one tick at a time, so a stalled transfer waits out the
+// retransmission timer. The server reads its inbound stream whenever the link goes idle.
+class SimulatedLink
+{
+public:
+  struct Config
+  {
+    size_t mtu = 1500;           // longest IPv4 datagram the link carries
+    double loss_rate_up = 0;     // chance of dropping each datagram from the client to the server
+    double loss_rate_dn = 0;     // ... and from the server to the client
+    uint64_t delay_ms = 0;       // one-way delay
+    double bandwidth = 0;        // bytes per millisecond through the bottleneck, or zero for no bottleneck
+    size_t queue_limit = 0;      // most datagrams waiting at the bottleneck, or zero for no limit
+    size_t write_size = 0;       // if nonzero, the client writes at most this much at a time ...
+    uint64_t write_every_ms = 0; // ... once every this many milliseconds
+    uint64_t tick_ms = 1;        // simulated time that passes each time the link goes idle
+    uint64_t max_ms = 600'000;   // give up once this much simulated time has passed
+    uint64_t seed = 0;
+  };
+
+  struct Result
+  {
+    double seconds {};            // wall-clock time of the transfer
+    uint64_t simulated_ms {};     // simulated time of the transfer
+    uint64_t datagrams {};        // datagrams offered to the link, in both directions
+    uint64_t dropped {};          // ... and how many of them it dropped
+    uint64_t overflowed {};       // ... of which for lack of room in a bottleneck queue
+    size_t peak_queue {};         // most datagrams ever waiting at a bottleneck
+    uint64_t client_datagrams {}; // datagrams the client offered to the link
+    size_t client_mss {};         // the client's MSS at the end, after any MTU probing
+    TCPSender::Stats client_stats {};
+  };
+
+  SimulatedLink( const TCPConfig& client, const TCPConfig& server, const Config& link )
+    : link_( link ), client_( client ), server_( server ), rd_( link.seed )
+  {
+    client_adapter_.config_mut().source = Address { "10.0.0.1", 1000 };
+    client_adapter_.config_mut().destination = Address { "10.0.0.2", 2000 };
+    server_adapter_.config_mut().source = Address { "10.0.0.2", 2000 };
+    server_adapter_.config_mut().destination = Address { "10.0.0.1", 1000 };
+  }
+
+  // Send `data` from the client to the server, and check that it arrives intact
+  Result transfer( const std::string& data )
+  {
+    Result result;
+    size_t written = 0;
+    uint64_t next_write_ms = now_ms_;
+    received_.clear();
+
+    const auto start_time = std::chrono::steady_clock::now();
+    while ( received_.size() < data.size() ) {
+      Writer& writer = client_.outbound_writer();
+      if ( written < data.size() && writer.available_capacity() > 0 && now_ms_ >= next_write_ms ) {
+        size_t len = std::min( writer.available_capacity(), data.size() - written );
+        if ( link_.write_size > 0 ) {
+          len = std::min( len, link_.write_size );
+          next_write_ms = now_ms_ + link_.write_every_ms;
+        }
+        writer.push( data.substr( written, len ) );
+        written += len;
+        client_.push( to_server_ );
+      }
+
+      if ( due( up_.queue ) || due( dn_.queue ) ) {
+        deliver( up_.queue, server_adapter_, server_, to_client_ );
+        deliver( dn_.queue, client_adapter_, client_, to_server_ );
+        continue;
+      }
+
+      Reader& reader = server_.inbound_reader();
+      while ( reader.bytes_buffered() > 0 ) {
+        const std::string_view peeked = reader.peek();
+        received_.append( peeked );
+        reader.pop( peeked.size() );
+      }
+      if ( received_.size() == data.size() ) {
+        break;
+      }
+
+      now_ms_ += link_.tick_ms;
+      client_.tick( link_.tick_ms, to_server_ );
+      server_.tick( link_.tick_ms, to_client_ );
+      if ( now_ms_ > link_.max_ms ) {
+        throw std::runtime_error( "transfer over the simulated link stalled" );
+      }
+    }
+    const auto stop_time = std::chrono::steady_clock::now();
+
+    if ( received_ != data ) {
+      throw std::runtime_error( "data sent over the simulated link arrived corrupted" );
+    }
+
+    result.seconds = std::chrono::duration<double>( stop_time - start_time ).count();
+    result.simulated_ms = now_ms_;
+    result.datagrams = datagrams_;
+    result.client_datagrams = up_.datagrams;
+    result.dropped = dropped_;
+    result.overflowed = overflowed_;
+    result.peak_queue = peak_queue_;
+    result.client_mss = client_.sender().mss();
+    result.client_stats = client_.sender().stats();
+    return result;
+  }
+
+private:
+  struct Datagram
+  {
+    double departure_ms; // when the bottleneck finishes sending it
+    uint64_t due_ms;     // when it arrives
+    std::vector<std::string> buffers;
+  };
+
+  struct Direction
+  {
+    double loss_rate;
+    std::deque<Datagram> queue {}; // in order of arrival
+    uint64_t datagrams {};
+  };
+
+  Config link_;
+  TCPPeer client_;
+  TCPPeer server_;
+  TCPOverIPv4Adapter client_adapter_ {};
+  TCPOverIPv4Adapter server_adapter_ {};
+  Direction up_ { link_.loss_rate_up };
+  Direction dn_ { link_.loss_rate_dn };
+  std::default_random_engine rd_;
+  uint64_t now_ms_ {};
+  uint64_t datagrams_ {};
+  uint64_t dropped_ {};
+  uint64_t overflowed_ {};
+  size_t peak_queue_ {};
+  std::string received_ {};
+
+  TCPPeer::TransmitFunction to_server_ = [this]( TCPMessage msg ) {
+    send( client_adapter_, msg, up_ );
+  };
+  TCPPeer::TransmitFunction to_client_ = [this]( TCPMessage msg ) {
+    send( server_adapter_, msg, dn_ );
+  };
+
+  void send( TCPOverIPv4Adapter& adapter, const TCPMessage& msg, Direction& direction )
+  {
+    ++datagrams_;
+    ++direction.datagrams;
+    std::vector<std::string> buffers = serialize( adapter.wrap_tcp_in_ip( msg ) );
+    size_t length = 0;
+    for ( const auto& buffer : buffers ) {
+      length += buffer.size();
+    }
+    if ( length > link_.mtu || std::bernoulli_distribution { direction.loss_rate }( rd_ ) ) {
+      ++dropped_;
+      return;
+    }
+
+    double departure_ms = static_cast<double>( now_ms_ );
+    if ( link_.bandwidth > 0 ) {
+      // the datagrams the bottleneck has not finished sending are the newest ones
+      size_t waiting = 0;
+      for ( auto it = direction.queue.rbegin();
+            it != direction.queue.rend() && it->departure_ms > static_cast<double>( now_ms_ );
+            ++it ) {
+        ++waiting;
+      }
+      if ( link_.queue_limit > 0 && waiting >= link_.queue_limit ) {
+        ++dropped_;
+        ++overflowed_;
+        return;
+      }
+      peak_queue_ = std::max( peak_queue_, waiting + 1 );
+      if ( not direction.queue.empty() ) {
+        departure_ms = std::max( departure_ms, direction.queue.back().departure_ms );
+      }
+      departure_ms += static_cast<double>( length ) / link_.bandwidth;
+    }
+    const auto due_ms = static_cast<uint64_t>( std::ceil( departure_ms ) ) + link_.delay_ms;
+    direction.queue.push_back( { departure_ms, due_ms, std::move( buffers ) } );
+  }
+
+  bool due( const std::deque<Datagram>& queue ) const
+  {
+    return not queue.empty() && queue.front().due_ms <= now_ms_;
+  }
+
+  void deliver( std::deque<Datagram>& queue,
+                TCPOverIPv4Adapter& adapter,
+                TCPPeer& peer,
+                const TCPPeer::TransmitFunction& reply ) const
+  {
+    if ( not due( queue ) ) {
+      return;
+    }
+    InternetDatagram dgram;
+    if ( not parse( dgram, queue.front().buffers ) ) {
+      throw std::runtime_error( "simulated link carried an unparseable datagram" );
+    }
+    queue.pop_front();
+    auto msg = adapter.unwrap_tcp_in_ip( dgram );
+    if ( not msg.has_value() ) {
+      throw std::runtime_error( "simulated link carried a datagram that is not for the peer" );
+    }
+    peer.receive( std::move( msg.value() ), reply );
+  }
+};
@@ -0,0 +1,99 @@
+#include "simulated_link.hh"
+
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+// Transfers the same data between two TCPPeers over a simulated link, written a few bytes every millisecond
+// as an interactive application would, sending each write at once, with Nagle's algorithm and corked, and
+// reports the segments per byte and the simulated time each needed.
+
+namespace {
+
+constexpr uint64_t DELAY_MS = 10;
+
+string mode_name( TCPConfig::Coalescing coalescing )
+{
+  switch ( coalescing ) {
+    case TCPConfig::Coalescing::Nagle:
+      return "Nagle";
+    case TCPConfig::Coalescing::Cork:
+      return "cork";
+    case TCPConfig::Coalescing::NoDelay:
+      break;
+  }
+  return "no delay";
+}
+
+SimulatedLink::Result run( const string& data, size_t write_size, TCPConfig::Coalescing coalescing )
+{
+  TCPConfig client;
+  client.coalescing = coalescing;
+  TCPConfig server;
+  server.isn = Wrap32 { 12345 };
+
+  SimulatedLink link {
+    client, server, { .delay_ms = DELAY_MS, .write_size = write_size, .write_every_ms = 1, .seed = 789 } };
+  const SimulatedLink::Result result = link.transfer( data );
+
+  cout << setw( 3 ) << write_size << "-byte writes, " << setw( 8 ) << mode_name( coalescing ) << ": "
+       << setw( 5 ) << result.client_datagrams << " segments, " << fixed << setprecision( 4 )
+       << static_cast<double>( result.client_datagrams ) / static_cast<double>( data.size() )
+       << " segments per byte, " << setw( 5 ) << result.simulated_ms << " ms simulated.\n";
+  return result;
+}
+
+void program_body()
+{
+  const string data = [] {
+    default_random_engine rd { 789 };
+    uniform_int_distribution<char> ud;
+    string ret;
+    for ( size_t i = 0; i < 10'000; ++i ) {
+      ret += ud( rd );
+    }
+    return ret;
+  }();
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  for ( const size_t write_size : { 1, 10, 100 } ) {
+    const auto no_delay = run( data, write_size, TCPConfig::Coalescing::NoDelay );
+    const auto nagle = run( data, write_size, TCPConfig::Coalescing::Nagle );
+    const auto cork = run( data, write_size, TCPConfig::Coalescing::Cork );
+
+    debug_output << "             TCP with " << setw( 3 ) << write_size << "-byte writes: " << fixed
+                 << setprecision( 1 )
+                 << static_cast<double>( no_delay.client_datagrams ) / static_cast<double>( nagle.client_datagrams )
+                 << "x fewer segments with Nagle, "
+                 << static_cast<double>( no_delay.client_datagrams ) / static_cast<double>( cork.client_datagrams )
+                 << "x corked\n";
+
+    // holding small writes back has to batch them into fewer segments
+    if ( nagle.client_datagrams >= no_delay.client_datagrams
+         || cork.client_datagrams >= no_delay.client_datagrams ) {
+      throw runtime_error( "holding small segments did not reduce the segment count" );
+    }
+  }
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
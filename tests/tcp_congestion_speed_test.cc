@@ -0,0 +1,106 @@
+#include "simulated_link.hh"
+
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+using namespace std;
+
+// Transfers the same data between two TCPPeers over simulated lossy links with each congestion-control
+// algorithm, and reports the goodput each reaches in simulated time.
+
+namespace {
+
+using Algorithm = CongestionControl::Algorithm;
+
+constexpr uint64_t DELAY_MS = 10;
+
+string algorithm_name( Algorithm algorithm )
+{
+  switch ( algorithm ) {
+    case Algorithm::NewReno:
+      return "NewReno";
+    case Algorithm::Cubic:
+      return "CUBIC";
+    case Algorithm::None:
+      break;
+  }
+  return "none";
+}
+
+// returns the goodput, in Mbit/s of simulated time
+double run( const string& data, Algorithm algorithm, double loss_rate )
+{
+  TCPConfig client;
+  client.congestion_control = algorithm;
+  TCPConfig server;
+  server.isn = Wrap32 { 12345 };
+
+  SimulatedLink link {
+    client, server, { .loss_rate_up = loss_rate, .loss_rate_dn = loss_rate, .delay_ms = DELAY_MS, .seed = 789 } };
+  const SimulatedLink::Result result = link.transfer( data );
+
+  const double goodput = 8 * static_cast<double>( data.size() ) / static_cast<double>( result.simulated_ms ) / 1e3;
+  cout << "loss " << setw( 2 ) << static_cast<int>( loss_rate * 100 ) << "%, " << setw( 7 )
+       << algorithm_name( algorithm ) << ": " << fixed << setprecision( 2 ) << setw( 6 ) << goodput << " Mbit/s ("
+       << setw( 6 ) << result.simulated_ms << " ms simulated, " << setw( 5 ) << result.datagrams << " datagrams, "
+       << setw( 4 ) << result.dropped << " dropped).\n";
+  return goodput;
+}
+
+void program_body()
+{
+  const string data = [] {
+    default_random_engine rd { 789 };
+    uniform_int_distribution<char> ud;
+    string ret;
+    for ( size_t i = 0; i < 2'000'000; ++i ) {
+      ret += ud( rd );
+    }
+    return ret;
+  }();
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  for ( const double loss_rate : { 0.0, 0.01, 0.05 } ) {
+    map<Algorithm, double> goodput;
+    for ( const auto algorithm : { Algorithm::None, Algorithm::NewReno, Algorithm::Cubic } ) {
+      goodput[algorithm] = run( data, algorithm, loss_rate );
+    }
+
+    if ( loss_rate > 0 ) {
+      debug_output << "             TCP goodput at " << static_cast<int>( loss_rate * 100 )
+                   << "% loss: " << fixed << setprecision( 2 ) << goodput[Algorithm::None] << " Mbit/s without "
+                   << "congestion control, " << goodput[Algorithm::NewReno] << " NewReno, "
+                   << goodput[Algorithm::Cubic] << " CUBIC\n";
+
+      // recovering from most losses without a timeout has to beat waiting out the timer
+      for ( const auto algorithm : { Algorithm::NewReno, Algorithm::Cubic } ) {
+        if ( goodput[algorithm] < goodput[Algorithm::None] ) {
+          throw runtime_error( algorithm_name( algorithm ) + " reached less goodput than no congestion control" );
+        }
+      }
+    }
+  }
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,89 @@
+#include "simulated_link.hh"
+
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+// Transfers the same data between two TCPPeers over simulated links of different MTUs, with fixed MSSes and
+// with path MTU probing, and reports the throughput and segment count of each.
+
+namespace {
+
+constexpr size_t IP_AND_TCP_HEADERS = 40;
+
+SimulatedLink::Result run( const string& data, size_t mss, size_t probe_mss, size_t mtu )
+{
+  TCPConfig client;
+  client.mss = mss;
+  client.probe_mss = probe_mss;
+  TCPConfig server;
+  server.isn = Wrap32 { 12345 };
+
+  SimulatedLink link { client, server, { .mtu = mtu } };
+  const SimulatedLink::Result result = link.transfer( data );
+
+  cout << "MTU " << setw( 4 ) << mtu << ", MSS " << setw( 4 ) << mss;
+  if ( probe_mss > 0 ) {
+    cout << " probing to " << setw( 4 ) << probe_mss << " (reached " << setw( 4 ) << result.client_mss << ")";
+  } else {
+    cout << string( 29, ' ' );
+  }
+  cout << ": " << setw( 6 ) << result.datagrams << " datagrams, " << fixed << setprecision( 2 )
+       << 8 * static_cast<double>( data.size() ) / result.seconds / 1e9 << " Gbit/s.\n";
+  return result;
+}
+
+void program_body()
+{
+  const string data = [] {
+    default_random_engine rd { 789 };
+    uniform_int_distribution<char> ud;
+    string ret;
+    for ( size_t i = 0; i < 16'000'000; ++i ) {
+      ret += ud( rd );
+    }
+    return ret;
+  }();
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  const auto baseline = run( data, TCPConfig::MAX_PAYLOAD_SIZE, 0, 1500 );
+  run( data, 1500 - IP_AND_TCP_HEADERS, 0, 1500 );
+  const auto jumbo = run( data, 9000 - IP_AND_TCP_HEADERS, 0, 9000 );
+  const auto probed_jumbo = run( data, TCPConfig::MAX_PAYLOAD_SIZE, 9000 - IP_AND_TCP_HEADERS, 9000 );
+  const auto probed_ethernet = run( data, TCPConfig::MAX_PAYLOAD_SIZE, 9000 - IP_AND_TCP_HEADERS, 1500 );
+
+  debug_output << "             TCP over 9000-byte MTU: " << fixed << setprecision( 2 )
+               << baseline.seconds / jumbo.seconds << "x the throughput of 1000-byte segments\n";
+
+  // probing must find the largest segment each link carries, to within the search granularity
+  if ( probed_jumbo.client_mss != 9000 - IP_AND_TCP_HEADERS ) {
+    throw runtime_error( "MTU probing did not reach the 9000-byte MTU" );
+  }
+  if ( probed_ethernet.client_mss > 1500 - IP_AND_TCP_HEADERS
+       || probed_ethernet.client_mss < 1500 - IP_AND_TCP_HEADERS - 64 ) {
+    throw runtime_error( "MTU probing settled at " + to_string( probed_ethernet.client_mss )
+                         + " bytes on a 1500-byte MTU" );
+  }
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,99 @@
+#include "simulated_link.hh"
+
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+// Transfers the same data between two TCPPeers through a simulated 10 Mbit/s bottleneck with a short queue,
+// written in bursts of 32 kB every 50 ms (half the bottleneck's bandwidth, but far more at once than the queue
+// holds), sending each window at once, pacing it over the RTT, and pacing at a fixed rate, and reports the
+// simulated time, the datagrams the queue dropped and its peak occupancy for each.
+
+namespace {
+
+constexpr double BANDWIDTH = 1250; // bytes per millisecond
+constexpr size_t QUEUE_LIMIT = 8;
+constexpr uint64_t DELAY_MS = 10;
+constexpr size_t WRITE_SIZE = 32'000;
+constexpr uint64_t WRITE_EVERY_MS = 50;
+
+SimulatedLink::Result run( const string& data, const string& label, uint64_t pacing_rate, bool pacing )
+{
+  TCPConfig client;
+  client.congestion_control = CongestionControl::Algorithm::NewReno;
+  client.min_rto = 200;
+  client.fast_retransmit = true;
+  client.sack_retransmit = true;
+  client.pacing_rate = pacing_rate;
+  client.pacing = pacing;
+  TCPConfig server;
+  server.isn = Wrap32 { 12345 };
+  server.min_rto = 200;
+  server.sack_blocks = 4;
+
+  SimulatedLink link { client,
+                       server,
+                       { .delay_ms = DELAY_MS,
+                         .bandwidth = BANDWIDTH,
+                         .queue_limit = QUEUE_LIMIT,
+                         .write_size = WRITE_SIZE,
+                         .write_every_ms = WRITE_EVERY_MS,
+                         .seed = 789 } };
+  const SimulatedLink::Result result = link.transfer( data );
+
+  const TCPSender::Stats& stats = result.client_stats;
+  cout << setw( 22 ) << label << ": " << setw( 5 ) << result.simulated_ms << " ms simulated, " << setw( 4 )
+       << result.overflowed << " dropped at the bottleneck, at most " << setw( 2 ) << result.peak_queue
+       << " queued, " << setw( 4 ) << stats.fast_retransmissions + stats.selective_retransmissions
+       << " resent fast, " << setw( 2 ) << stats.timeout_retransmissions << " on timeout.\n";
+  return result;
+}
+
+void program_body()
+{
+  const string data = [] {
+    default_random_engine rd { 789 };
+    uniform_int_distribution<char> ud;
+    string ret;
+    for ( size_t i = 0; i < 1'000'000; ++i ) {
+      ret += ud( rd );
+    }
+    return ret;
+  }();
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  const auto bursty = run( data, "unpaced", 0, false );
+  const auto paced = run( data, "paced over the RTT", 0, true );
+  const auto fixed_rate = run( data, "paced at 8 Mbit/s", 1'000'000, false );
+
+  debug_output << "             TCP through a " << QUEUE_LIMIT << "-datagram queue: " << bursty.overflowed
+               << " drops unpaced, " << paced.overflowed << " paced over the RTT, " << fixed_rate.overflowed
+               << " at a fixed rate\n";
+
+  // spreading each burst out has to keep the queue from overflowing as often as sending it at once does
+  if ( paced.overflowed >= bursty.overflowed || fixed_rate.overflowed >= bursty.overflowed ) {
+    throw runtime_error( "pacing did not reduce the drops at the bottleneck" );
+  }
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
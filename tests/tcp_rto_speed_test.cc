@@ -0,0 +1,109 @@
+#include "simulated_link.hh"
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Runs many short transfers between two TCPPeers over a lossy simulated link with a 100 ms round trip,
+// with the fixed one-second RTO and with the RTO adapted to the measured RTT, each with and without fast
+// retransmit, and reports the percentiles of their completion times.
+
+namespace {
+
+constexpr size_t TRANSFERS = 1000;
+constexpr uint64_t DELAY_MS = 50;
+constexpr double LOSS_RATE = 0.02;
+constexpr uint64_t MIN_RTO_MS = 200;
+
+struct Percentiles
+{
+  uint64_t p50, p90, p99, max;
+};
+
+Percentiles run( const string& data, uint64_t min_rto, bool fast_retransmit )
+{
+  vector<uint64_t> completion_ms;
+  uint64_t fast_retransmissions = 0;
+  uint64_t timeout_retransmissions = 0;
+  for ( size_t i = 0; i < TRANSFERS; ++i ) {
+    TCPConfig client;
+    client.min_rto = min_rto;
+    client.fast_retransmit = fast_retransmit;
+    TCPConfig server;
+    server.isn = Wrap32 { 12345 };
+    server.min_rto = min_rto;
+
+    SimulatedLink link {
+      client, server, { .loss_rate_up = LOSS_RATE, .loss_rate_dn = LOSS_RATE, .delay_ms = DELAY_MS, .seed = i } };
+    const SimulatedLink::Result result = link.transfer( data );
+    completion_ms.push_back( result.simulated_ms );
+    fast_retransmissions += result.client_stats.fast_retransmissions;
+    timeout_retransmissions += result.client_stats.timeout_retransmissions;
+  }
+  ranges::sort( completion_ms );
+
+  const auto percentile = [&]( size_t p ) { return completion_ms.at( ( completion_ms.size() - 1 ) * p / 100 ); };
+  const Percentiles result { percentile( 50 ), percentile( 90 ), percentile( 99 ), completion_ms.back() };
+
+  cout << setw( 8 ) << ( min_rto > 0 ? "adaptive" : "fixed" ) << " RTO, fast retransmit " << setw( 3 )
+       << ( fast_retransmit ? "on" : "off" ) << ": p50 " << setw( 5 ) << result.p50 << " ms, p90 " << setw( 5 )
+       << result.p90 << " ms, p99 " << setw( 5 ) << result.p99 << " ms, max " << setw( 5 ) << result.max
+       << " ms (" << setw( 4 ) << fast_retransmissions << " fast, " << setw( 4 ) << timeout_retransmissions
+       << " timeout retransmissions).\n";
+  return result;
+}
+
+void program_body()
+{
+  const string data = [] {
+    default_random_engine rd { 789 };
+    uniform_int_distribution<char> ud;
+    string ret;
+    for ( size_t i = 0; i < 50'000; ++i ) {
+      ret += ud( rd );
+    }
+    return ret;
+  }();
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  const auto fixed_rto = run( data, 0, false );
+  const auto adaptive_rto = run( data, MIN_RTO_MS, false );
+  const auto fixed_rto_fast_retransmit = run( data, 0, true );
+  run( data, MIN_RTO_MS, true );
+
+  debug_output << "             TCP p90 completion: " << fixed_rto.p90 << " ms with fixed RTO, "
+               << adaptive_rto.p90 << " ms with adaptive RTO, " << fixed_rto_fast_retransmit.p90
+               << " ms with fast retransmit\n";
+
+  // on a 100 ms path, a loss should cost a few RTTs rather than a second
+  if ( adaptive_rto.p90 >= fixed_rto.p90 || adaptive_rto.p99 >= fixed_rto.p99 ) {
+    throw runtime_error( "adaptive RTO did not shorten the tail of completion times" );
+  }
+  if ( fixed_rto_fast_retransmit.p90 >= fixed_rto.p90 ) {
+    throw runtime_error( "fast retransmit did not shorten the tail of completion times" );
+  }
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,77 @@
+#include "conversions.hh"
+#include "random.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+// Check that the batch wrap and unwrap give exactly the scalar answers for every element
+void check_batch( const Wrap32 isn, const vector<uint64_t>& values, const uint64_t checkpoint )
+{
+  vector<Wrap32> wrapped( values.size(), Wrap32 { 0 } );
+  Wrap32::wrap( values, isn, wrapped );
+
+  vector<uint64_t> unwrapped( values.size() );
+  Wrap32::unwrap( wrapped, isn, checkpoint, unwrapped );
+
+  for ( size_t i = 0; i < values.size(); ++i ) {
+    const Wrap32 expected_seqno = Wrap32::wrap( values[i], isn );
+    const uint64_t expected_value = expected_seqno.unwrap( isn, checkpoint );
+    if ( not( wrapped[i] == expected_seqno ) or unwrapped[i] != expected_value ) {
+      ostringstream ss;
+      ss << "Batch wrap/unwrap disagreed with the scalar version\n";
+      ss << "  for value = " << values[i] << ", isn = " << isn << ", and checkpoint = " << checkpoint << ":\n";
+      ss << "  batch gave " << wrapped[i] << " and " << unwrapped[i] << ", scalar gave " << expected_seqno
+         << " and " << expected_value << "\n";
+      throw runtime_error( ss.str() );
+    }
+  }
+}
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+    uniform_int_distribution<uint32_t> dist32 { 0, numeric_limits<uint32_t>::max() };
+    uniform_int_distribution<uint64_t> dist63 { 0, uint64_t { 1 } << 63 };
+    uniform_int_distribution<uint64_t> near { 0, uint64_t { 1 } << 34 };
+
+    // the edges: small checkpoints, and values exactly half the sequence space away
+    const uint64_t half = uint64_t { 1 } << 31;
+    const uint64_t full = uint64_t { 1 } << 32;
+    const vector<uint64_t> edges { 0, 1, half - 1, half, half + 1, full - 1, full, 3 * full };
+    for ( const uint64_t checkpoint : edges ) {
+      vector<uint64_t> values;
+      for ( const uint64_t v : edges ) {
+        values.push_back( v );
+        values.push_back( checkpoint + v );
+        if ( checkpoint >= v ) {
+          values.push_back( checkpoint - v );
+        }
+      }
+      check_batch( Wrap32 { 0 }, values, checkpoint );
+      check_batch( Wrap32 { dist32( rd ) }, values, checkpoint );
+    }
+
+    for ( unsigned int i = 0; i < 10000; i++ ) {
+      const Wrap32 isn { dist32( rd ) };
+      const uint64_t checkpoint = i % 2 ? dist63( rd ) : near( rd );
+      vector<uint64_t> values( 64 );
+      for ( auto& v : values ) {
+        const uint64_t offset = near( rd );
+        v = i % 3 == 0 ? offset : checkpoint + offset - ( checkpoint >= full ? full : 0 );
+      }
+      check_batch( isn, values, checkpoint );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,77 @@
+#include "random.hh"
+#include "test_should_be.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+namespace {
+
+constexpr uint32_t max32 = numeric_limits<uint32_t>::max();
+constexpr uint32_t half = uint32_t { 1 } << 31;
+
+// arithmetic wraps around 2^32
+static_assert( Wrap32 { max32 } + 1 == Wrap32 { 0 } );
+static_assert( Wrap32 { 0 } - 1 == Wrap32 { max32 } );
+static_assert( Wrap32 { 5 } - Wrap32 { 3 } == 2 );
+static_assert( Wrap32 { 3 } - Wrap32 { 5 } == -2 );
+static_assert( Wrap32 { 1 } - Wrap32 { max32 } == 2 );
+static_assert( Wrap32 { max32 } - Wrap32 { 1 } == -2 );
+static_assert( Wrap32 { 1 }.distance_from( Wrap32 { max32 } ) == 2 );
+static_assert( Wrap32 { max32 }.distance_from( Wrap32 { 1 } ) == max32 - 1 );
+
+// serial-number order, including across the wrap
+static_assert( Wrap32 { 3 } < Wrap32 { 5 } );
+static_assert( not( Wrap32 { 5 } < Wrap32 { 3 } ) );
+static_assert( not( Wrap32 { 5 } < Wrap32 { 5 } ) );
+static_assert( Wrap32 { 5 } <= Wrap32 { 5 } );
+static_assert( Wrap32 { max32 } < Wrap32 { 0 } );
+static_assert( Wrap32 { max32 - 10 } < Wrap32 { 10 } );
+static_assert( Wrap32 { 10 } > Wrap32 { max32 - 10 } );
+static_assert( Wrap32 { 10 } >= Wrap32 { max32 - 10 } );
+static_assert( Wrap32 { 0 } < Wrap32 { half - 1 } );
+static_assert( Wrap32 { half + 1 } < Wrap32 { 0 } );
+
+// numbers exactly half the space apart are unordered (RFC 1982 leaves the comparison undefined)
+static_assert( not( Wrap32 { 0 } < Wrap32 { half } ) && not( Wrap32 { half } < Wrap32 { 0 } ) );
+static_assert( not( Wrap32 { 0 } <= Wrap32 { half } ) && not( Wrap32 { half } <= Wrap32 { 0 } ) );
+
+// wrap and unwrap are usable in constant expressions too
+static_assert( Wrap32::wrap( ( uint64_t { 1 } << 32 ) + 7, Wrap32 { max32 } ) == Wrap32 { 6 } );
+static_assert( Wrap32 { 6 }.unwrap( Wrap32 { max32 }, uint64_t { 1 } << 32 ) == ( uint64_t { 1 } << 32 ) + 7 );
+static_assert( Wrap32 { 6 }.unwrap( Wrap32 { max32 }, 0 ) == 7 );
+
+} // namespace
+
+int main()
+{
+  try {
+    // the order agrees with comparing unwrapped absolute sequence numbers that are close together
+    auto rd = get_random_engine();
+    uniform_int_distribution<uint32_t> dist32 { 0, max32 };
+    uniform_int_distribution<uint64_t> dist63 { uint64_t { 1 } << 32, uint64_t { 1 } << 63 };
+    uniform_int_distribution<uint64_t> offset { 0, half - 1 };
+
+    for ( unsigned int i = 0; i < 100000; i++ ) {
+      const Wrap32 isn { dist32( rd ) };
+      const uint64_t a = dist63( rd );
+      const uint64_t b = a + offset( rd );
+      const Wrap32 wa = Wrap32::wrap( a, isn );
+      const Wrap32 wb = Wrap32::wrap( b, isn );
+
+      test_should_be( wa < wb, a < b );
+      test_should_be( wb < wa, false );
+      test_should_be( wa <= wb, true );
+      test_should_be( static_cast<uint64_t>( wb - wa ), b - a );
+      test_should_be( wb.unwrap( isn, a ), b );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
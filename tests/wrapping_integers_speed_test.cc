@@ -0,0 +1,121 @@
+#include "wrapping_integers.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+// Times the scalar and batch Wrap32 wrap/unwrap over the same values, and checks they agree and that the batch
+// versions are no slower
+
+namespace {
+
+constexpr unsigned TRIALS = 11;   // report the best of this many runs, to reduce scheduling noise
+constexpr unsigned ROUNDS = 1000; // passes over the values in each run
+constexpr double TOLERANCE = 1.1; // how much slower than scalar a batch version may measure, for noise
+
+// Time `scalar` and `batch` in alternating runs, so both see the same conditions, and return the best of each
+template<typename S, typename B>
+pair<double, double> best_ns_per_value( size_t count, S&& scalar, B&& batch )
+{
+  const auto ns_per_value = [count]( auto&& f ) {
+    const auto start_time = steady_clock::now();
+    for ( unsigned round = 0; round < ROUNDS; ++round ) {
+      f();
+    }
+    const auto stop_time = steady_clock::now();
+    return duration_cast<duration<double, nano>>( stop_time - start_time ).count()
+           / static_cast<double>( count * ROUNDS );
+  };
+
+  pair<double, double> best { numeric_limits<double>::max(), numeric_limits<double>::max() };
+  for ( unsigned trial = 0; trial < TRIALS; ++trial ) {
+    best.first = min( best.first, ns_per_value( scalar ) );
+    best.second = min( best.second, ns_per_value( batch ) );
+  }
+  return best;
+}
+
+void speed_test( const size_t count, const size_t random_seed )
+{
+  default_random_engine rd { random_seed };
+  const Wrap32 isn { uniform_int_distribution<uint32_t> {}( rd ) };
+  const uint64_t checkpoint = uint64_t { 1 } << 40;
+
+  // absolute sequence numbers within a few windows of the checkpoint, as in a sender's queue
+  vector<uint64_t> values( count );
+  uniform_int_distribution<uint64_t> offset { 0, uint64_t { 1 } << 24 };
+  for ( auto& v : values ) {
+    v = checkpoint - ( uint64_t { 1 } << 23 ) + offset( rd );
+  }
+
+  vector<Wrap32> scalar_wrapped( count, Wrap32 { 0 } );
+  vector<uint64_t> scalar_unwrapped( count );
+  vector<Wrap32> batch_wrapped( count, Wrap32 { 0 } );
+  vector<uint64_t> batch_unwrapped( count );
+
+  // the scalar loops run to a vector's size, which (as for any real caller) the compiler does not know
+  const auto [scalar_wrap_ns, batch_wrap_ns] = best_ns_per_value(
+    count,
+    [&] {
+      for ( size_t i = 0; i < values.size(); ++i ) {
+        scalar_wrapped[i] = Wrap32::wrap( values[i], isn );
+      }
+    },
+    [&] { Wrap32::wrap( values, isn, batch_wrapped ); } );
+  const auto [scalar_unwrap_ns, batch_unwrap_ns] = best_ns_per_value(
+    count,
+    [&] {
+      for ( size_t i = 0; i < scalar_wrapped.size(); ++i ) {
+        scalar_unwrapped[i] = scalar_wrapped[i].unwrap( isn, checkpoint );
+      }
+    },
+    [&] { Wrap32::unwrap( batch_wrapped, isn, checkpoint, batch_unwrapped ); } );
+
+  if ( scalar_wrapped != batch_wrapped or scalar_unwrapped != batch_unwrapped or scalar_unwrapped != values ) {
+    throw runtime_error( "Mismatch between scalar and batch Wrap32 results" );
+  }
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  cout << fixed << setprecision( 2 ) << "Wrap32 over " << count << " values: wrap " << scalar_wrap_ns
+       << " ns/value scalar, " << batch_wrap_ns << " ns/value batch (" << scalar_wrap_ns / batch_wrap_ns
+       << "x); unwrap " << scalar_unwrap_ns << " ns/value scalar, " << batch_unwrap_ns << " ns/value batch ("
+       << scalar_unwrap_ns / batch_unwrap_ns << "x).\n";
+
+  debug_output << "             Wrap32 batch unwrap: " << fixed << setprecision( 2 ) << batch_unwrap_ns
+               << " ns/value (" << scalar_unwrap_ns / batch_unwrap_ns << "x scalar)\n";
+
+  if ( batch_unwrap_ns > 100 ) {
+    throw runtime_error( "Wrap32 batch unwrap did not meet minimum speed of 100 ns/value." );
+  }
+  if ( batch_wrap_ns > TOLERANCE * scalar_wrap_ns or batch_unwrap_ns > TOLERANCE * scalar_unwrap_ns ) {
+    throw runtime_error( "Wrap32 batch wrap or unwrap was slower than the scalar version." );
+  }
+}
+
+} // namespace
+
+int main()
+{
+  try {
+    speed_test( 4096, 789 ); // a send window's worth of segments, which stays in cache
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
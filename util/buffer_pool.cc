@@ -0,0 +1,96 @@
+#include "buffer_pool.hh"
+
+#include <sstream>
+
+using namespace std;
+
+BufferPool& BufferPool::global()
+{
+  // never destroyed, so streams that outlive static destruction can still give their buffers back
+  static auto* pool = new BufferPool; // NOLINT(*-owning-memory)
+  return *pool;
+}
+
+string BufferPool::take( size_t size )
+{
+  string ret;
+  if ( size > MAX_BLOCK_SIZE ) {
+    ret.reserve( size );
+    return ret;
+  }
+
+  // smallest class whose blocks hold `size` bytes
+  size_t index = 0;
+  while ( ( MIN_BLOCK_SIZE << index ) < size ) {
+    ++index;
+  }
+
+  {
+    const lock_guard lock { mutex_ };
+    auto& size_class = classes_.at( index );
+    ++size_class.stats.takes;
+    if ( not size_class.free.empty() ) {
+      ret = move( size_class.free.back() );
+      size_class.free.pop_back();
+      ++size_class.stats.reuses;
+      --size_class.stats.cached;
+      return ret;
+    }
+  }
+
+  ret.reserve( MIN_BLOCK_SIZE << index );
+  return ret;
+}
+
+void BufferPool::give( string&& buffer )
+{
+  const size_t capacity = buffer.capacity();
+  if ( capacity < MIN_BLOCK_SIZE or capacity >= 2 * MAX_BLOCK_SIZE ) {
+    return; // too small to be worth caching, or too big to file under any class
+  }
+
+  // largest class whose block size this buffer can serve
+  size_t index = 0;
+  while ( index + 1 < NUM_CLASSES and ( MIN_BLOCK_SIZE << ( index + 1 ) ) <= capacity ) {
+    ++index;
+  }
+
+  buffer.clear();
+  const lock_guard lock { mutex_ };
+  auto& size_class = classes_.at( index );
+  ++size_class.stats.gives;
+  if ( size_class.free.size() < MAX_CACHED_PER_CLASS ) {
+    size_class.free.push_back( move( buffer ) );
+    ++size_class.stats.cached;
+  }
+}
+
+array<BufferPool::ClassStats, BufferPool::NUM_CLASSES> BufferPool::stats() const
+{
+  array<ClassStats, NUM_CLASSES> ret {};
+  const lock_guard lock { mutex_ };
+  for ( size_t i = 0; i < NUM_CLASSES; ++i ) {
+    ret.at( i ) = classes_.at( i ).stats;
+    ret.at( i ).block_size = MIN_BLOCK_SIZE << i;
+  }
+  return ret;
+}
+
+string BufferPool::to_string() const
+{
+  ostringstream out;
+  for ( const auto& s : stats() ) {
+    out << s.block_size / 1024 << " KiB: " << s.takes << " taken (" << s.reuses << " reused), " << s.gives
+        << " given back, " << s.cached << " cached\n";
+  }
+  return out.str();
+}
+
+void BufferPool::clear()
+{
+  const lock_guard lock { mutex_ };
+  for ( auto& size_class : classes_ ) {
+    size_class.free.clear();
+    size_class.stats.cached = 0;
+  }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// A process-wide cache of string buffers, sorted into power-of-two size classes from 2 KiB (one MTU-sized
+// frame) up to 64 KiB. Code that is done with a large buffer hands it back with give() instead of freeing it,
+// and a later take() of a similar size reuses that allocation instead of going to the heap.
+class BufferPool
+{
+public:
+  static constexpr size_t MIN_BLOCK_SIZE = 2048;
+  static constexpr size_t NUM_CLASSES = 6;
+  static constexpr size_t MAX_BLOCK_SIZE = MIN_BLOCK_SIZE << ( NUM_CLASSES - 1 );
+  static constexpr size_t MAX_CACHED_PER_CLASS = 256; // beyond this, given-back buffers are freed
+
+  // Occupancy of one size class
+  struct ClassStats
+  {
+    size_t block_size {};
+    uint64_t takes {};  // take() calls served by this class
+    uint64_t reuses {}; // ... of which reused a cached buffer
+    uint64_t gives {};  // buffers handed back to this class
+    uint64_t cached {}; // buffers currently held for reuse
+  };
+
+  // The pool shared by every ByteStream and datagram reader in the process
+  static BufferPool& global();
+
+  // Returns an empty string with capacity for at least `size` bytes
+  std::string take( size_t size );
+
+  // Hands back a buffer that is no longer needed (its contents are discarded)
+  void give( std::string&& buffer );
+
+  std::array<ClassStats, NUM_CLASSES> stats() const;
+  std::string to_string() const;
+
+  // Frees every cached buffer
+  void clear();
+
+private:
+  struct SizeClass
+  {
+    std::vector<std::string> free {};
+    ClassStats stats {};
+  };
+
+  mutable std::mutex mutex_ {};
+  std::array<SizeClass, NUM_CLASSES> classes_ {};
+};
@@ -1,5 +1,6 @@
 #include "file_descriptor.hh"
 
+#include "buffer_pool.hh"
 #include "exception.hh"
 
 #include <algorithm>
@@ -83,6 +84,9 @@ FileDescriptor FileDescriptor::duplicate() const
 void FileDescriptor::read( string& buffer )
 {
   if ( buffer.empty() ) {
+    if ( buffer.capacity() < kReadBufferSize ) {
+      buffer = BufferPool::global().take( kReadBufferSize );
+    }
     buffer.resize( kReadBufferSize );
   }
 
@@ -115,6 +119,9 @@ void FileDescriptor::read( vector<string>& buffers )
   }
 
   buffers.back().clear();
+  if ( buffers.back().capacity() < kReadBufferSize ) {
+    buffers.back() = BufferPool::global().take( kReadBufferSize );
+  }
   buffers.back().resize( kReadBufferSize );
 
   vector<iovec> iovecs;
@@ -151,6 +158,37 @@ void FileDescriptor::read( vector<string>& buffers )
   }
 }
 
+size_t FileDescriptor::read( const vector<span<char>>& buffers )
+{
+  vector<iovec> iovecs;
+  iovecs.reserve( buffers.size() );
+  size_t total_size = 0;
+  for ( const auto x : buffers ) {
+    iovecs.push_back( { x.data(), x.size() } );
+    total_size += x.size();
+  }
+
+  const ssize_t bytes_read = ::readv( fd_num(), iovecs.data(), static_cast<int>( iovecs.size() ) );
+  if ( bytes_read < 0 ) {
+    if ( internal_fd_->non_blocking_ and ( errno == EAGAIN or errno == EINPROGRESS ) ) {
+      return 0;
+    }
+    throw unix_error { "readv" };
+  }
+
+  register_read();
+
+  if ( bytes_read == 0 and total_size != 0 ) {
+    internal_fd_->eof_ = true;
+  }
+
+  if ( bytes_read > static_cast<ssize_t>( total_size ) ) {
+    throw runtime_error( "read() read more than requested" );
+  }
+
+  return bytes_read;
+}
+
 size_t FileDescriptor::write( string_view buffer )
 {
   return write( vector<string_view> { buffer } );
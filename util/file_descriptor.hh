@@ -3,6 +3,8 @@
 #include <cstddef>
 #include <limits>
 #include <memory>
+#include <span>
+#include <string>
 #include <vector>
 
 // A reference-counted handle to a file descriptor
@@ -44,9 +46,6 @@ class FileDescriptor
   explicit FileDescriptor( std::shared_ptr<FDWrapper> other_shared_ptr );
 
 protected:
-  // size of buffer to allocate for read()
-  static constexpr size_t kReadBufferSize = 16384;
-
   void set_eof() { internal_fd_->eof_ = true; }
   void register_read() { ++internal_fd_->read_count_; }   // increment read count
   void register_write() { ++internal_fd_->write_count_; } // increment write count
@@ -55,6 +54,9 @@ protected:
   T CheckSystemCall( std::string_view s_attempt, T return_value ) const;
 
 public:
+  // size of buffer to allocate for read()
+  static constexpr size_t kReadBufferSize = 16384;
+
   // Construct from a file descriptor number returned by the kernel
   explicit FileDescriptor( int fd );
 
@@ -65,6 +67,10 @@ public:
   void read( std::string& buffer );
   void read( std::vector<std::string>& buffers );
 
+  // Read directly into caller-owned memory
+  // returns number of bytes read
+  size_t read( const std::vector<std::span<char>>& buffers );
+
   // Attempt to write a buffer
   // returns number of bytes written
   size_t write( std::string_view buffer );
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "address.hh"
+#include "congestion_control.hh"
 #include "wrapping_integers.hh"
 
 #include <cstddef>
@@ -16,10 +17,36 @@ public:
   static constexpr uint16_t TIMEOUT_DFLT = 1000;    //!< Default re-transmit timeout is 1 second
   static constexpr unsigned MAX_RETX_ATTEMPTS = 8;  //!< Maximum re-transmit attempts before giving up
 
+  //! What the sender does with less than a full segment of data
+  enum class Coalescing
+  {
+    NoDelay, //!< send it at once
+    Nagle,   //!< hold it while any data is unacknowledged (RFC 896)
+    Cork,    //!< hold it until a full segment builds up or the stream closes, for at most 200 ms
+  };
+
   uint16_t rt_timeout = TIMEOUT_DFLT;      //!< Initial value of the retransmission timeout, in milliseconds
+  uint64_t min_rto = 0;                    //!< If nonzero, adapt the RTO to the measured RTT, down to this
+  uint64_t max_rto = 60000;                //!< Most the adaptive RTO grows to, backoff included
+  bool fast_retransmit = false;            //!< If true, resend on the third duplicate ACK, even without cc
+  bool sack_retransmit = false;            //!< If true, resend every hole the peer's SACK blocks show lost
+  uint64_t pacing_rate = 0;                //!< If nonzero, most bytes per second the sender paces out
+  bool pacing = false;                     //!< If true, pace each window over the RTT (needs min_rto)
   size_t recv_capacity = DEFAULT_CAPACITY; //!< Receive capacity, in bytes
+  size_t max_recv_capacity = 0;            //!< If above recv_capacity, autotune the receive window up to this
   size_t send_capacity = DEFAULT_CAPACITY; //!< Sender capacity, in bytes
+  size_t mss = MAX_PAYLOAD_SIZE;           //!< Most payload bytes per segment to start with
+  size_t probe_mss = 0;                    //!< If above mss, probe the path for segments up to this size
+  size_t max_fragments = 0;                //!< If nonzero, most out-of-order fragments the receiver stores
+  double max_fragment_overhead = 0;        //!< If nonzero, most reassembler memory per out-of-order byte
+  size_t sack_blocks = 0;                  //!< If nonzero, most SACK blocks the receiver reports (up to 4)
   Wrap32 isn { 137 };                      //!< Default initial sequence number
+
+  //! Sender congestion control (by default none: the receiver's window alone limits the flight)
+  CongestionControl::Algorithm congestion_control = CongestionControl::Algorithm::None;
+
+  //! Sender handling of small writes (by default none: every push sends what is buffered)
+  Coalescing coalescing = Coalescing::NoDelay;
 };
 
 //! Config for classes derived from FdAdapter
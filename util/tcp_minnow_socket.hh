@@ -58,6 +58,10 @@ public:
   // Return peer address from underlying datagram adapter
   const Address& peer_address() const { return _datagram_adapter.config().destination; }
 
+  //! The sender's and reassembler's counters as the connection ended; valid after wait_until_closed()
+  const TCPSender::Stats& sender_stats() const { return _sender_stats; }
+  const Reassembler::Stats& reassembler_stats() const { return _reassembler_stats; }
+
 protected:
   //! Adapter to underlying datagram socket (e.g., UDP or IP)
   AdaptT _datagram_adapter;
@@ -72,6 +76,10 @@ private:
   //! TCP state machine
   std::optional<TCPPeer> _tcp {};
 
+  //! Copied from the TCPPeer when the connection ends, for the owner to read
+  TCPSender::Stats _sender_stats {};
+  Reassembler::Stats _reassembler_stats {};
+
   //! eventloop that handles all the events (new inbound datagram, new outbound bytes, new inbound bytes)
   EventLoop _eventloop {};
 
@@ -18,10 +18,17 @@ class TCPPeer
   }
 
 public:
-  explicit TCPPeer( const TCPConfig& cfg ) : cfg_( cfg ) {}
+  explicit TCPPeer( const TCPConfig& cfg ) : cfg_( cfg )
+  {
+    receiver_.set_autotune_limit( cfg_.max_recv_capacity );
+    receiver_.set_reassembler_limits( { cfg_.max_fragments, cfg_.max_fragment_overhead } );
+    receiver_.set_sack_blocks( cfg_.sack_blocks );
+    sender_.configure( cfg_ );
+  }
 
   Writer& outbound_writer() { return sender_.writer(); }
   Reader& inbound_reader() { return receiver_.reader(); }
+  const Reassembler& reassembler() const { return receiver_.reassembler(); }
 
   /* Type of the `transmit` function that the push and tick methods can use to send messages */
   using TransmitFunction = std::function<void( TCPMessage )>;
@@ -89,7 +96,7 @@ public:
 private:
   TCPConfig cfg_;
   TCPSender sender_ { ByteStream { cfg_.send_capacity }, cfg_.isn, cfg_.rt_timeout };
-  TCPReceiver receiver_ { Reassembler { ByteStream { cfg_.recv_capacity } } };
+  TCPReceiver receiver_ { Reassembler { ByteStream { cfg_.recv_capacity, ByteStream::Storage::Chunked } } };
 
   bool need_send_ {};
 
@@ -3,6 +3,8 @@
 #include "wrapping_integers.hh"
 
 #include <optional>
+#include <utility>
+#include <vector>
 
 /*
  * The TCPReceiverMessage structure contains the information sent from a TCP receiver to its sender.
@@ -17,6 +19,9 @@
  *    the <cstdint> header).
  *
  * 3) The RST (reset) flag. If set, the stream has suffered an error and the connection should be aborted.
+ *
+ * 4) Selective acknowledgment (SACK) blocks, as in RFC 2018: ranges [left, right) of sequence numbers that
+ *    the receiver already holds beyond the ackno, lowest first. Empty unless the receiver reports them.
  */
 
 struct TCPReceiverMessage
@@ -24,4 +29,5 @@ struct TCPReceiverMessage
   std::optional<Wrap32> ackno {};
   uint16_t window_size {};
   bool RST {};
+  std::vector<std::pair<Wrap32, Wrap32>> sack {};
 };
@@ -2,10 +2,16 @@
 #include "checksum.hh"
 #include "wrapping_integers.hh"
 
+#include <algorithm>
 #include <cstddef>
 
 static constexpr uint32_t TCPHeaderMinLen = 5; // 32-bit words
 
+// TCP option kinds
+static constexpr uint8_t TCPOptionEnd = 0;
+static constexpr uint8_t TCPOptionNop = 1;
+static constexpr uint8_t TCPOptionSack = 5;
+
 using namespace std;
 
 void TCPSegment::parse( Parser& parser, uint32_t datagram_layer_pseudo_checksum )
@@ -47,11 +53,43 @@ void TCPSegment::parse( Parser& parser, uint32_t datagram_layer_pseudo_checksum
   parser.integer( udinfo.cksum );
   parser.integer( raw16 ); // urgent pointer
 
-  // skip any options or anything extra in the header
   if ( data_offset < TCPHeaderMinLen ) {
     parser.set_error();
+    return;
   }
-  parser.remove_prefix( data_offset * 4 - TCPHeaderMinLen * 4 );
+
+  // read SACK blocks from the options, and skip any other options or anything extra in the header
+  size_t options_len = data_offset * 4 - TCPHeaderMinLen * 4;
+  while ( options_len > 0 and not parser.has_error() ) {
+    parser.integer( octet ); // kind
+    --options_len;
+    if ( octet == TCPOptionEnd ) {
+      break;
+    }
+    if ( octet == TCPOptionNop ) {
+      continue;
+    }
+
+    const uint8_t kind = octet;
+    parser.integer( octet ); // length, including the kind and length octets
+    if ( octet < 2 or octet - 1U > options_len ) {
+      parser.set_error();
+      return;
+    }
+    options_len -= octet - 1U;
+
+    size_t body_len = octet - 2U;
+    if ( kind == TCPOptionSack and body_len % 8 == 0 ) {
+      for ( ; body_len > 0; body_len -= 8 ) {
+        uint32_t left {};
+        parser.integer( left );
+        parser.integer( raw32 );
+        message.receiver.sack.emplace_back( Wrap32 { left }, Wrap32 { raw32 } );
+      }
+    }
+    parser.remove_prefix( body_len );
+  }
+  parser.remove_prefix( options_len );
 
   parser.all_remaining( message.sender.payload );
 }
@@ -68,7 +106,7 @@ void TCPSegment::serialize( Serializer& serializer ) const
   serializer.integer( udinfo.dst_port );
   serializer.integer( Wrap32Serializable { message.sender.seqno }.raw_value() );
   serializer.integer( Wrap32Serializable { message.receiver.ackno.value_or( Wrap32 { 0 } ) }.raw_value() );
-  serializer.integer( uint8_t { TCPHeaderMinLen << 4 } ); // data offset
+  serializer.integer( static_cast<uint8_t>( header_length() / 4 << 4 ) ); // data offset
   const bool reset = message.sender.RST or message.receiver.RST;
   const uint8_t flags = ( message.receiver.ackno.has_value() ? 0b0001'0000U : 0 ) | ( reset ? 0b0000'0100U : 0 )
                         | ( message.sender.SYN ? 0b0000'0010U : 0 ) | ( message.sender.FIN ? 0b0000'0001U : 0 );
@@ -76,9 +114,29 @@ void TCPSegment::serialize( Serializer& serializer ) const
   serializer.integer( message.receiver.window_size );
   serializer.integer( udinfo.cksum );
   serializer.integer( uint16_t { 0 } ); // urgent pointer
+
+  // SACK option, padded to a 32-bit boundary with two NOPs in front
+  const size_t sack_blocks = min( message.receiver.sack.size(), MAX_SACK_BLOCKS );
+  if ( sack_blocks > 0 ) {
+    serializer.integer( TCPOptionNop );
+    serializer.integer( TCPOptionNop );
+    serializer.integer( TCPOptionSack );
+    serializer.integer( static_cast<uint8_t>( 2 + 8 * sack_blocks ) );
+    for ( size_t i = 0; i < sack_blocks; ++i ) {
+      serializer.integer( Wrap32Serializable { message.receiver.sack[i].first }.raw_value() );
+      serializer.integer( Wrap32Serializable { message.receiver.sack[i].second }.raw_value() );
+    }
+  }
+
   serializer.buffer( message.sender.payload );
 }
 
+size_t TCPSegment::header_length() const
+{
+  const size_t sack_blocks = min( message.receiver.sack.size(), MAX_SACK_BLOCKS );
+  return TCPHeaderMinLen * 4 + ( sack_blocks > 0 ? 4 + 8 * sack_blocks : 0 );
+}
+
 void TCPSegment::compute_checksum( uint32_t datagram_layer_pseudo_checksum )
 {
   udinfo.cksum = 0;
@@ -20,4 +20,10 @@ struct TCPSegment
   void serialize( Serializer& serializer ) const;
 
   void compute_checksum( uint32_t datagram_layer_pseudo_checksum );
+
+  // Length of the serialized header, including any options, in bytes
+  size_t header_length() const;
+
+  // At most this many SACK blocks fit in the 40 bytes of TCP options
+  static constexpr size_t MAX_SACK_BLOCKS = 4;
 };
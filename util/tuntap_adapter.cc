@@ -1,4 +1,5 @@
 #include "tuntap_adapter.hh"
+#include "buffer_pool.hh"
 #include "parser.hh"
 
 using namespace std;
@@ -9,9 +10,13 @@ optional<TCPMessage> TCPOverIPv4OverTunFdAdapter::read()
   strs.front().resize( IPv4Header::LENGTH );
   _tun.read( strs );
 
+  // the parser copies what it keeps, so the payload buffer can go straight back to the pool
   InternetDatagram ip_dgram;
-  const vector<string> buffers = { strs.at( 0 ), strs.at( 1 ) };
-  if ( parse( ip_dgram, buffers ) ) {
+  const bool parsed = parse( ip_dgram, strs );
+  for ( auto& str : strs ) {
+    BufferPool::global().give( move( str ) );
+  }
+  if ( parsed ) {
     return unwrap_tcp_in_ip( ip_dgram );
   }
   return {};